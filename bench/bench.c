@@ -0,0 +1,230 @@
+// Times the maths functions the graph is drawn with, built on its own
+// without SDL by make bench
+
+#define _POSIX_C_SOURCE 199309L
+
+#include    <math.h>
+#include    <time.h>
+#include   <stdio.h>
+#include  <stdlib.h>
+#include <stdbool.h>
+#include   "maths.h"
+#include  "memory.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_TSC 1
+#endif
+
+// How many inputs each benchmark runs over when not given on the command line
+#define BENCH_DEFAULT_COUNT (1 << 20)
+// How many times each benchmark runs, the fastest run is reported
+#define BENCH_RUNS 5
+// How far out the random points are
+#define BENCH_RANGE 100.0
+
+//
+//      INPUTS
+//
+
+int count;
+Point* points;
+Vector* vectors;
+Vector* others;
+// Where benchmarks put vectors, so none of them changes another's inputs
+Vector* results;
+Vector* other_results;
+Plane* planes;
+Tuple2* tuples;
+Tuple3* triples;
+void** pointers;
+ViewBasis basis;
+PolarVector view = { 5, 0.7, 0.4 };
+Vector view_v, view_u, view_w;
+// Results are added into this so the compiler can't drop the work
+volatile double sink;
+
+double randomRange(double min, double max) {
+    return min + (max - min) * rand() / RAND_MAX;
+}
+
+void makeInputs() {
+    points = malloc(sizeof(Point) * count);
+    vectors = malloc(sizeof(Vector) * count);
+    others = malloc(sizeof(Vector) * count);
+    results = malloc(sizeof(Vector) * count);
+    other_results = malloc(sizeof(Vector) * count);
+    planes = malloc(sizeof(Plane) * count);
+    tuples = malloc(sizeof(Tuple2) * count);
+    triples = malloc(sizeof(Tuple3) * count);
+    pointers = malloc(sizeof(void*) * count);
+    for (int i = 0; i < count; i++) {
+        points[i] = (Point) { randomRange(-BENCH_RANGE, BENCH_RANGE),
+                randomRange(-BENCH_RANGE, BENCH_RANGE), randomRange(-BENCH_RANGE, BENCH_RANGE) };
+        vectors[i] = (Vector) { randomRange(-1, 1), randomRange(-1, 1), randomRange(-1, 1) };
+        others[i] = (Vector) { randomRange(-1, 1), randomRange(-1, 1), randomRange(-1, 1) };
+        planes[i] = (Plane) { randomRange(-1, 1), randomRange(-1, 1), randomRange(-1, 1), randomRange(-10, 10) };
+    }
+    viewBasisFromPolar(&basis, &view);
+    // The view's basis as the reference projection finds it
+    Plane viewPlane;
+    vectorFromPolar(&view_v, &view);
+    normalPlane(&viewPlane, &view_v);
+    viewPlane.constant = view.r;
+    getOrthonormals(&viewPlane, &view_u, &view_w);
+}
+
+void freeInputs() {
+    free(points);
+    free(vectors);
+    free(others);
+    free(results);
+    free(other_results);
+    free(planes);
+    free(tuples);
+    free(triples);
+    free(pointers);
+}
+
+//
+//      BENCHMARKS
+//
+
+// Projects to window coordinates through the view's basis, as the graph
+// does for every point
+void benchProject() {
+    for (int i = 0; i < count; i++) {
+        Tuple3 t;
+        viewBasisProject(&t, &basis, &points[i]);
+        tuples[i].a = 320 + t.a / view.r;
+        tuples[i].b = 240 + t.b / view.r;
+    }
+    sink += tuples[count - 1].a;
+}
+
+// Projects by solving for the point in the view's basis, as the graph
+// used to for every point
+void benchProjectSolve() {
+    for (int i = 0; i < count; i++) {
+        Tuple3 t;
+        directionTo(&t, &view_v, &view_u, &view_w, &points[i]);
+        tuples[i].a = 320 + t.c / view.r;
+        tuples[i].b = 240 - t.b / view.r;
+    }
+    sink += tuples[count - 1].a;
+}
+
+void benchGetOrthonormals() {
+    for (int i = 0; i < count; i++) getOrthonormals(&planes[i], &results[i], &other_results[i]);
+    sink += results[count - 1].x + other_results[count - 1].y;
+}
+
+void benchDirectionTo() {
+    Vector w;
+    crossVector(&w, &view_v, &view_u);
+    for (int i = 0; i < count; i++) directionTo(&triples[i], &vectors[i], &others[i], &w, &points[i]);
+    sink += triples[count - 1].a;
+}
+
+// Each run reduces a copy of the inputs, so every run starts from the
+// same vectors, an operation is the copy and the reduction
+void benchReduceToUnit() {
+    for (int i = 0; i < count; i++) {
+        results[i] = vectors[i];
+        reduceToUnit(&results[i]);
+    }
+    sink += results[count - 1].x;
+}
+
+void benchCrossVector() {
+    for (int i = 0; i < count; i++) {
+        Vector o;
+        crossVector(&o, &vectors[i], &others[i]);
+        triples[i].a = o.x;
+    }
+    sink += triples[count - 1].a;
+}
+
+// Each allocator benchmark makes every object then frees every object, so
+// an operation is one of each
+void benchVector() {
+    for (int i = 0; i < count; i++) pointers[i] = initVector(i, 0, 0);
+    for (int i = 0; i < count; i++) freeVector(pointers[i]);
+}
+
+void benchPoint() {
+    for (int i = 0; i < count; i++) pointers[i] = initPoint(i, 0, 0);
+    for (int i = 0; i < count; i++) freePoint(pointers[i]);
+}
+
+void benchPlane() {
+    for (int i = 0; i < count; i++) pointers[i] = initPlane(i, 0, 0, 0);
+    for (int i = 0; i < count; i++) freePlane(pointers[i]);
+}
+
+void benchLine() {
+    for (int i = 0; i < count; i++) pointers[i] = initLine(i, 0, 0, 0, 0, 0);
+    for (int i = 0; i < count; i++) freeLine(pointers[i]);
+}
+
+typedef struct Benchmark_ {
+    const char* name;
+    void (*run)();
+} Benchmark;
+
+const Benchmark benchmarks[] = {
+    { "project (basis)", benchProject },
+    { "project (solve)", benchProjectSolve },
+    { "getOrthonormals", benchGetOrthonormals },
+    { "directionTo", benchDirectionTo },
+    { "reduceToUnit", benchReduceToUnit },
+    { "crossVector", benchCrossVector },
+    { "initVector/freeVector", benchVector },
+    { "initPoint/freePoint", benchPoint },
+    { "initPlane/freePlane", benchPlane },
+    { "initLine/freeLine", benchLine }
+};
+
+double seconds() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+unsigned long long ticks() {
+#ifdef BENCH_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+int main(int n, char const *args[]) {
+    count = n > 1 ? atoi(args[1]) : BENCH_DEFAULT_COUNT;
+    if (count <= 0) count = BENCH_DEFAULT_COUNT;
+    srand(1);
+    makeInputs();
+    printf("%d inputs, fastest of %d runs\n\n", count, BENCH_RUNS);
+    // The time stamp counter ticks at a fixed reference rate rather than
+    // with the core's clock, so these aren't core cycles
+    printf("%-24s %10s %10s\n", "", "ns/op", "tsc/op");
+    for (int b = 0; b < (int) (sizeof(benchmarks) / sizeof(benchmarks[0])); b++) {
+        double best = INFINITY, best_ticks = INFINITY;
+        for (int r = 0; r < BENCH_RUNS; r++) {
+            double start = seconds();
+            unsigned long long start_ticks = ticks();
+            benchmarks[b].run();
+            double taken = seconds() - start;
+            double taken_ticks = (double) (ticks() - start_ticks);
+            if (taken < best) best = taken;
+            if (taken_ticks < best_ticks) best_ticks = taken_ticks;
+        }
+#ifdef BENCH_TSC
+        printf("%-24s %10.2f %10.2f\n", benchmarks[b].name, best * 1e9 / count, best_ticks / count);
+#else
+        printf("%-24s %10.2f %10s\n", benchmarks[b].name, best * 1e9 / count, "-");
+#endif
+    }
+    freeInputs();
+    return 0;
+}
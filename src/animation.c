@@ -0,0 +1,77 @@
+#include        <SDL.h>
+#include       <math.h>
+#include     <stdlib.h>
+#include     <string.h>
+#include    <stdbool.h>
+#include      "maths.h"
+#include       "item.h"
+#include "expression.h"
+#include  "animation.h"
+
+bool animationEquals(ItemData* a, ItemData* b) {
+    return strcmp(((Animation*) a)->source, ((Animation*) b)->source) == 0;
+}
+
+// Evaluates the values that are expressions of t
+void animateValues(ItemData* data, double t, double* values) {
+    Animation* a = (Animation*) data;
+    for (int i = 0; i < MAX_ITEM_VALUES; i++) {
+        if (a->timed[i]) values[i] = Expression_evaluateAt(&a->values[i], 0, 0, 0, t);
+    }
+}
+
+void freeAnimation(ItemData* data) {
+    Animation* a = (Animation*) data;
+    free(a->source);
+    free(a);
+}
+
+// Parses up to count values after a command's name into the array, each
+// a number or an expression of t without spaces such as cos(t) or 2*pi,
+// stopping at the first that is neither, returns the expressions of t if
+// there are any and NULL if every value is fixed, in which case they are
+// only evaluated at t = 0
+Animation* parseValues(const char* s, int count, double* values) {
+    Animation* a = NULL;
+    Expression e;
+    char value[ANIMATION_VALUE_LENGTH + 1];
+    // Skip the name
+    while (*s == ' ' || *s == '\t') s++;
+    while (*s != '\0' && *s != ' ' && *s != '\t') s++;
+    const char* start = s;
+    for (int i = 0; i < count; i++) {
+        while (*s == ' ' || *s == '\t') s++;
+        int length = 0;
+        while (s[length] != '\0' && s[length] != ' ' && s[length] != '\t') length++;
+        if (length == 0 || length > ANIMATION_VALUE_LENGTH) break;
+        memcpy(value, s, length);
+        value[length] = '\0';
+        s += length;
+        char* end;
+        values[i] = strtod(value, &end);
+        if (*end == '\0') continue;
+        // Values are points in space so can't depend on x, y or z, like a
+        // bad number this keeps any number it starts with and stops
+        if (!compileExpression(&e, value) || (e.variables & ~EXPRESSION_T) != 0) break;
+        values[i] = Expression_evaluateAt(&e, 0, 0, 0, 0);
+        if (e.variables == 0) continue;
+        if (a == NULL) {
+            a = malloc(sizeof(Animation));
+            for (int j = 0; j < MAX_ITEM_VALUES; j++) a->timed[j] = false;
+            SDL_AtomicSet(&a->data.refs, 1);
+            a->data.timed = true;
+            a->data.animate = animateValues;
+            a->data.equals = animationEquals;
+            a->data.free = freeAnimation;
+        }
+        a->timed[i] = true;
+        a->values[i] = e;
+    }
+    if (a != NULL) {
+        int length = s - start;
+        a->source = malloc(length + 1);
+        memcpy(a->source, start, length);
+        a->source[length] = '\0';
+    }
+    return a;
+}
@@ -0,0 +1,22 @@
+#ifndef ANIMATION_H_
+#define ANIMATION_H_
+
+// The longest text each value of an item can be
+#define ANIMATION_VALUE_LENGTH 255
+
+// The values of an item that change with the time t, kept as the data of
+// any item whose command only takes numbers
+typedef struct Animation_ {
+
+    ItemData data;
+    // The values as written, to tell animations apart
+    char* source;
+    // Which values are expressions of t, the rest stay as parsed
+    bool timed[MAX_ITEM_VALUES];
+    Expression values[MAX_ITEM_VALUES];
+
+} Animation;
+
+Animation* parseValues(const char* s, int count, double* values);
+
+#endif
@@ -0,0 +1,97 @@
+#include        <SDL.h>
+#include       <math.h>
+#include     <stdlib.h>
+#include    <stdbool.h>
+#include      "maths.h"
+#include "threadPool.h"
+#include     "bounds.h"
+
+void initialiseBounds(Bounds* b) {
+    b->min = (Point) { INFINITY, INFINITY, INFINITY };
+    b->max = (Point) { -INFINITY, -INFINITY, -INFINITY };
+}
+
+bool Bounds_empty(Bounds* b) {
+    return b->min.x > b->max.x;
+}
+
+void Bounds_addPoint(Bounds* b, Point* p) {
+    Bounds_addBox(b, p, 0, 0, 0);
+}
+
+// Adds the box reaching the distances either side of the centre along
+// each axis
+void Bounds_addBox(Bounds* b, Point* centre, double x, double y, double z) {
+    x = fabs(x);
+    y = fabs(y);
+    z = fabs(z);
+    if (centre->x - x < b->min.x) b->min.x = centre->x - x;
+    if (centre->y - y < b->min.y) b->min.y = centre->y - y;
+    if (centre->z - z < b->min.z) b->min.z = centre->z - z;
+    if (centre->x + x > b->max.x) b->max.x = centre->x + x;
+    if (centre->y + y > b->max.y) b->max.y = centre->y + y;
+    if (centre->z + z > b->max.z) b->max.z = centre->z + z;
+}
+
+void Bounds_merge(Bounds* b, Bounds* other) {
+    if (Bounds_empty(other)) return;
+    Bounds_addPoint(b, &other->min);
+    Bounds_addPoint(b, &other->max);
+}
+
+// Points split into chunks, each reduced to its own bounds
+typedef struct BoundsJobs_ {
+    Point* points;
+    int count;
+    Bounds* partial;
+} BoundsJobs;
+
+// Reduces one chunk of points, the minimums and maximums are written as
+// selects with no other branches so compilers can vectorise the loop,
+// points that aren't numbers are skipped by the comparisons
+void boundsJob(void* data, int job, int worker) {
+    BoundsJobs* jobs = data;
+    int start = job * BOUNDS_CHUNK;
+    int end = start + BOUNDS_CHUNK < jobs->count ? start + BOUNDS_CHUNK : jobs->count;
+    Point* p = jobs->points;
+    double min_x = INFINITY, min_y = INFINITY, min_z = INFINITY;
+    double max_x = -INFINITY, max_y = -INFINITY, max_z = -INFINITY;
+    for (int i = start; i < end; i++) {
+        min_x = p[i].x < min_x ? p[i].x : min_x;
+        min_y = p[i].y < min_y ? p[i].y : min_y;
+        min_z = p[i].z < min_z ? p[i].z : min_z;
+        max_x = p[i].x > max_x ? p[i].x : max_x;
+        max_y = p[i].y > max_y ? p[i].y : max_y;
+        max_z = p[i].z > max_z ? p[i].z : max_z;
+    }
+    jobs->partial[job].min = (Point) { min_x, min_y, min_z };
+    jobs->partial[job].max = (Point) { max_x, max_y, max_z };
+}
+
+// Adds many points, split into chunks that the pool's workers reduce at
+// the same time before they are merged
+void Bounds_addPoints(Bounds* b, Point* points, int count, ThreadPool* pool) {
+    int chunks = (count + BOUNDS_CHUNK - 1) / BOUNDS_CHUNK;
+    if (chunks == 0) return;
+    BoundsJobs jobs = { points, count, malloc(sizeof(Bounds) * chunks) };
+    ThreadPool_run(pool, chunks, boundsJob, &jobs);
+    for (int i = 0; i < chunks; i++) {
+        // A chunk of points that aren't numbers stays empty on one axis
+        if (jobs.partial[i].min.y > jobs.partial[i].max.y) continue;
+        if (jobs.partial[i].min.z > jobs.partial[i].max.z) continue;
+        Bounds_merge(b, &jobs.partial[i]);
+    }
+    free(jobs.partial);
+}
+
+// Gets the sphere around the box
+void Bounds_sphere(Bounds* b, Point* centre, double* radius) {
+    if (Bounds_empty(b)) {
+        *centre = (Point) { 0, 0, 0 };
+        *radius = 0;
+        return;
+    }
+    *centre = (Point) { (b->min.x + b->max.x) / 2, (b->min.y + b->max.y) / 2, (b->min.z + b->max.z) / 2 };
+    double x = b->max.x - centre->x, y = b->max.y - centre->y, z = b->max.z - centre->z;
+    *radius = sqrt(x * x + y * y + z * z);
+}
@@ -0,0 +1,21 @@
+#ifndef BOUNDS_H_
+#define BOUNDS_H_
+
+// How many points each job of a parallel reduction takes
+#define BOUNDS_CHUNK 65536
+
+// An axis aligned box around points, empty until one is added
+typedef struct Bounds_ {
+    Point min;
+    Point max;
+} Bounds;
+
+void initialiseBounds(Bounds* b);
+bool Bounds_empty(Bounds* b);
+void Bounds_addPoint(Bounds* b, Point* p);
+void Bounds_addBox(Bounds* b, Point* centre, double x, double y, double z);
+void Bounds_merge(Bounds* b, Bounds* other);
+void Bounds_addPoints(Bounds* b, Point* points, int count, ThreadPool* pool);
+void Bounds_sphere(Bounds* b, Point* centre, double* radius);
+
+#endif
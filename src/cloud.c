@@ -0,0 +1,90 @@
+#include     <SDL.h>
+#include   <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include <stdbool.h>
+#include   "maths.h"
+#include    "item.h"
+#include   "cloud.h"
+
+bool cloudEquals(ItemData* a, ItemData* b) {
+    return strcmp(((Cloud*) a)->source, ((Cloud*) b)->source) == 0;
+}
+
+void freeCloud(ItemData* data) {
+    Cloud* c = (Cloud*) data;
+    free(c->source);
+    free(c->points);
+    free(c);
+}
+
+// Adds the point in the first three columns of the line, separated by
+// commas, semicolons or spaces, skipping lines such as headers that
+// don't start with three numbers
+void addCloudLine(Cloud* c, char* line) {
+    double v[3];
+    for (int k = 0; k < 3; k++) {
+        while (*line == ',' || *line == ';' || *line == ' ' || *line == '\t') line++;
+        char* end;
+        v[k] = strtod(line, &end);
+        if (end == line) return;
+        line = end;
+    }
+    if (c->count == c->capacity) {
+        c->capacity = c->capacity == 0 ? 1024 : c->capacity * 2;
+        c->points = realloc(c->points, sizeof(Point) * c->capacity);
+    }
+    c->points[c->count++] = (Point) { v[0], v[1], v[2] };
+}
+
+// Parses "scatter file" or "path file", streaming the file's x, y and z
+// columns through a buffer of CLOUD_BUFFER bytes so only the points are
+// kept, returning NULL if the file can't be read
+Cloud* parseCloud(const char* s) {
+    // The width matches CLOUD_NAME_LENGTH
+    char name[CLOUD_NAME_LENGTH + 1];
+    if (sscanf(s, "%*s %255s", name) != 1) return NULL;
+    FILE* f = fopen(name, "r");
+    if (f == NULL) return NULL;
+    Cloud* c = malloc(sizeof(Cloud));
+    c->source = malloc(strlen(s) + 1);
+    strcpy(c->source, s);
+    SDL_AtomicSet(&c->data.refs, 1);
+    c->data.timed = false;
+    c->data.animate = NULL;
+    c->data.equals = cloudEquals;
+    c->data.free = freeCloud;
+    c->count = 0;
+    c->capacity = 0;
+    c->points = NULL;
+    char* buffer = malloc(CLOUD_BUFFER + 1);
+    // The start of a line carried over from the last read, and whether
+    // the rest of a line too long to fit is being skipped
+    size_t kept = 0;
+    bool skipping = false;
+    while (true) {
+        size_t read = fread(buffer + kept, 1, CLOUD_BUFFER - kept, f);
+        size_t end = kept + read, start = 0;
+        for (size_t i = kept; i < end; i++) {
+            if (buffer[i] != '\n') continue;
+            buffer[i] = '\0';
+            if (!skipping) addCloudLine(c, buffer + start);
+            skipping = false;
+            start = i + 1;
+        }
+        if (read == 0) {
+            buffer[end] = '\0';
+            if (!skipping && start < end) addCloudLine(c, buffer + start);
+            break;
+        }
+        kept = end - start;
+        memmove(buffer, buffer + start, kept);
+        if (kept == CLOUD_BUFFER) {
+            kept = 0;
+            skipping = true;
+        }
+    }
+    free(buffer);
+    fclose(f);
+    return c;
+}
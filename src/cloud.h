@@ -0,0 +1,25 @@
+#ifndef CLOUD_H_
+#define CLOUD_H_
+
+// How much of a file is read at once, lines longer than this are skipped
+#define CLOUD_BUFFER 65536
+// The longest file name a cloud can be loaded from
+#define CLOUD_NAME_LENGTH 255
+
+// Points loaded from a CSV file, drawn as separate points or joined up
+// as a path, kept as the data of a scatter or path item
+typedef struct Cloud_ {
+
+    ItemData data;
+    // The command as written, to tell clouds apart
+    char* source;
+
+    int count;
+    int capacity;
+    Point* points;
+
+} Cloud;
+
+Cloud* parseCloud(const char* s);
+
+#endif
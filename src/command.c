@@ -0,0 +1,45 @@
+#include        <SDL.h>
+#include     <string.h>
+#include    <stdbool.h>
+#include      "maths.h"
+#include       "item.h"
+#include "expression.h"
+#include      "field.h"
+#include      "cloud.h"
+#include    "command.h"
+
+ItemData* parseFieldData(const char* s) {
+    return (ItemData*) parseField(s);
+}
+
+ItemData* parseCloudData(const char* s) {
+    return (ItemData*) parseCloud(s);
+}
+
+const Command commands[] = {
+    { "cylinder", ITEM_CYLINDER, "x y z dx dy dz r", 7, NULL, drawCylinderItem, boundCylinderItem },
+    { "ellipsoid", ITEM_ELLIPSOID, "x y z rx ry rz", 6, NULL, drawEllipsoidItem, boundEllipsoidItem },
+    { "field", ITEM_FIELD, "fx fy fz [n]", 0, parseFieldData, drawFieldItem, boundFieldItem },
+    { "intersect", ITEM_INTERSECT, "", 0, NULL, drawIntersectItem, boundIntersectItem },
+    { "line", ITEM_LINE, "x y z dx dy dz", 6, NULL, drawLineItem, boundPointItem },
+    { "path", ITEM_PATH, "file", 0, parseCloudData, drawPathItem, boundCloudItem },
+    { "plane", ITEM_PLANE, "a b c d", 4, NULL, drawPlaneItem, boundPlaneItem },
+    { "point", ITEM_POINT, "x y z", 3, NULL, drawPointItem, boundPointItem },
+    { "scatter", ITEM_SCATTER, "file", 0, parseCloudData, drawScatterItem, boundCloudItem },
+    { "sphere", ITEM_SPHERE, "x y z r", 4, NULL, drawSphereItem, boundSphereItem }
+};
+const int commandCount = sizeof(commands) / sizeof(commands[0]);
+
+// Finds the command with exactly this name by a binary search of the
+// table, or NULL if there isn't one
+const Command* findCommand(const char* name) {
+    int low = 0, high = commandCount - 1;
+    while (low <= high) {
+        int mid = (low + high) / 2;
+        int order = strcmp(name, commands[mid].name);
+        if (order == 0) return &commands[mid];
+        if (order < 0) high = mid - 1;
+        else low = mid + 1;
+    }
+    return NULL;
+}
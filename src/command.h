@@ -0,0 +1,52 @@
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+// The bounds the commands add to, from bounds.h
+struct Bounds_;
+
+// Defines a command that can be typed as an item, what it parses to and
+// how it is drawn
+typedef struct Command_ {
+    const char* name;
+    ItemType type;
+    // The arguments as written after the name, to show how it is used
+    const char* arguments;
+    // How many numbers the command takes, the rest are left as zero
+    int values;
+    // Parses what the item keeps besides its numbers, returning NULL if
+    // the line is wrong for the command, or is NULL if there is nothing
+    ItemData* (*parse)(const char* s);
+    void (*draw)(Item* item);
+    // Adds what the item draws to the bounds
+    void (*bound)(Item* item, struct Bounds_* b);
+} Command;
+
+// Every command, sorted by name
+extern const Command commands[];
+extern const int commandCount;
+
+const Command* findCommand(const char* name);
+
+// How each command is drawn, defined in main.c
+void drawPlaneItem(Item* item);
+void drawPointItem(Item* item);
+void drawLineItem(Item* item);
+void drawSphereItem(Item* item);
+void drawEllipsoidItem(Item* item);
+void drawCylinderItem(Item* item);
+void drawFieldItem(Item* item);
+void drawScatterItem(Item* item);
+void drawPathItem(Item* item);
+void drawIntersectItem(Item* item);
+
+// How the bounds of each command are found, defined in main.c
+void boundPlaneItem(Item* item, struct Bounds_* b);
+void boundPointItem(Item* item, struct Bounds_* b);
+void boundSphereItem(Item* item, struct Bounds_* b);
+void boundEllipsoidItem(Item* item, struct Bounds_* b);
+void boundCylinderItem(Item* item, struct Bounds_* b);
+void boundFieldItem(Item* item, struct Bounds_* b);
+void boundCloudItem(Item* item, struct Bounds_* b);
+void boundIntersectItem(Item* item, struct Bounds_* b);
+
+#endif
@@ -0,0 +1,126 @@
+#include        <SDL.h>
+#include       <math.h>
+#include     <stdlib.h>
+#include     <string.h>
+#include    <stdbool.h>
+#include      "maths.h"
+#include "threadPool.h"
+#include    "density.h"
+
+// The colours the density ramps through from the fewest points to the
+// most, spaced evenly
+const SDL_Color densityRamp[] = {
+    { 30, 40, 140, 255 },
+    { 120, 40, 170, 255 },
+    { 220, 60, 90, 255 },
+    { 255, 160, 40, 255 },
+    { 255, 250, 200, 255 }
+};
+
+DensityMap* initialiseDensityMap(SDL_Renderer* renderer, int width, int height, ThreadPool* pool) {
+    DensityMap* d = malloc(sizeof(DensityMap));
+    d->width = width;
+    d->height = height;
+    d->pool = pool;
+    d->workers = d->pool->workers;
+    d->counts = calloc((size_t) d->workers * width * height, sizeof(Uint32));
+    d->pixels = malloc(sizeof(Uint32) * width * height);
+    d->texture = NULL;
+    if (renderer != NULL) {
+        d->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                SDL_TEXTUREACCESS_STREAMING, width, height);
+        if (d->texture != NULL) SDL_SetTextureBlendMode(d->texture, SDL_BLENDMODE_BLEND);
+    }
+    // Interpolate the ramp into a table of every level
+    int stops = sizeof(densityRamp) / sizeof(densityRamp[0]);
+    for (int i = 0; i < DENSITY_LEVELS; i++) {
+        double t = (double) i / (DENSITY_LEVELS - 1) * (stops - 1);
+        int s = t >= stops - 1 ? stops - 2 : (int) t;
+        double f = t - s;
+        const SDL_Color* a = &densityRamp[s];
+        const SDL_Color* b = &densityRamp[s + 1];
+        Uint32 red = a->r + f * (b->r - a->r), green = a->g + f * (b->g - a->g), blue = a->b + f * (b->b - a->b);
+        d->levels[i] = 0xFF000000 | red << 16 | green << 8 | blue;
+    }
+    d->count = 0;
+    d->dirty = false;
+    return d;
+}
+
+// Forgets every point, ready for a new frame
+void DensityMap_clear(DensityMap* d) {
+    memset(d->counts, 0, sizeof(Uint32) * d->workers * d->width * d->height);
+    d->count = 0;
+    d->dirty = true;
+}
+
+// Projects one chunk of points and counts them into the worker's own
+// counts, points off the map or that aren't numbers are skipped
+void splatJob(void* data, int job, int worker) {
+    DensityMap* d = data;
+    Uint32* counts = d->counts + (size_t) worker * d->width * d->height;
+    double mid_x = d->width >> 1, mid_y = d->height >> 1;
+    int start = job * DENSITY_CHUNK;
+    int end = start + DENSITY_CHUNK < d->point_count ? start + DENSITY_CHUNK : d->point_count;
+    for (int i = start; i < end; i++) {
+        Tuple3 t;
+        viewBasisProject(&t, d->basis, &d->points[i]);
+        double x = mid_x + t.a * d->scale, y = mid_y + t.b * d->scale;
+        if (!(x >= 0 && x < d->width && y >= 0 && y < d->height)) continue;
+        counts[(int) y * d->width + (int) x]++;
+    }
+}
+
+// Splats the points projected through the basis and zoomed out by r, as
+// the graph projects them, split into chunks across the pool's workers
+void DensityMap_addPoints(DensityMap* d, Point* points, int count, ViewBasis* basis, double r) {
+    int chunks = (count + DENSITY_CHUNK - 1) / DENSITY_CHUNK;
+    if (chunks == 0) return;
+    d->points = points;
+    d->point_count = count;
+    d->basis = basis;
+    d->scale = 1 / r;
+    ThreadPool_run(d->pool, chunks, splatJob, d);
+    d->points = NULL;
+    d->count += count;
+    d->dirty = true;
+}
+
+// Merges every worker's counts into the first and tone maps them to the
+// pixels, logarithmically so sparse areas still show next to the
+// densest, pixels with no points are left clear
+void DensityMap_resolve(DensityMap* d) {
+    int size = d->width * d->height;
+    Uint32 most = 0;
+    for (int i = 0; i < size; i++) {
+        Uint32 total = d->counts[i];
+        for (int w = 1; w < d->workers; w++) total += d->counts[(size_t) w * size + i];
+        d->counts[i] = total;
+        if (total > most) most = total;
+    }
+    double scale = most > 0 ? (DENSITY_LEVELS - 1) / log1p(most) : 0;
+    for (int i = 0; i < size; i++) {
+        Uint32 c = d->counts[i];
+        d->pixels[i] = c == 0 ? 0 : d->levels[(int) (log1p(c) * scale)];
+    }
+    // The other workers' counts are merged now, so they start again
+    memset(d->counts + size, 0, sizeof(Uint32) * (d->workers - 1) * size);
+    d->dirty = false;
+}
+
+// Uploads the pixels to the texture and draws it over the renderer
+void drawDensityMap(DensityMap* d, SDL_Renderer* renderer) {
+    if (d->texture == NULL) return;
+    if (d->dirty) {
+        DensityMap_resolve(d);
+        SDL_UpdateTexture(d->texture, NULL, d->pixels, d->width * sizeof(Uint32));
+    }
+    SDL_RenderCopy(renderer, d->texture, NULL, NULL);
+}
+
+void freeDensityMap(DensityMap* d) {
+    if (d->texture != NULL) SDL_DestroyTexture(d->texture);
+    free(d->pixels);
+    free(d->counts);
+    free(d);
+}
@@ -0,0 +1,47 @@
+#ifndef DENSITY_H_
+#define DENSITY_H_
+
+// How many points each job of a splat takes
+#define DENSITY_CHUNK 65536
+// How many colours the density is tone mapped to
+#define DENSITY_LEVELS 256
+
+// Counts of the points projected onto each pixel, each worker splatting
+// into its own counts so no two threads write to the same place, merged
+// and tone mapped to colours when drawn
+typedef struct DensityMap_ {
+
+    int width;
+    int height;
+    // The counts of each worker one after another, the first also holds
+    // the merged counts once resolved
+    int workers;
+    Uint32* counts;
+    Uint32* pixels;
+    SDL_Texture* texture;
+    Uint32 levels[DENSITY_LEVELS];
+
+    // How many points have been splatted and whether the pixels are
+    // out of date
+    long count;
+    bool dirty;
+
+    // The points of the splat being run and how they are projected
+    Point* points;
+    int point_count;
+    ViewBasis* basis;
+    double scale;
+
+    // The workers splats are run on, shared and freed by the caller
+    ThreadPool* pool;
+
+} DensityMap;
+
+DensityMap* initialiseDensityMap(SDL_Renderer* renderer, int width, int height, ThreadPool* pool);
+void DensityMap_clear(DensityMap* d);
+void DensityMap_addPoints(DensityMap* d, Point* points, int count, ViewBasis* basis, double r);
+void DensityMap_resolve(DensityMap* d);
+void drawDensityMap(DensityMap* d, SDL_Renderer* renderer);
+void freeDensityMap(DensityMap* d);
+
+#endif
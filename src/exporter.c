@@ -0,0 +1,145 @@
+#include      <SDL.h>
+#include     <math.h>
+#include    <stdio.h>
+#include   <stdarg.h>
+#include   <stdlib.h>
+#include  <stdbool.h>
+#include    "maths.h"
+#include "exporter.h"
+
+// Writes the buffer out to the file
+void Exporter_flush(Exporter* e) {
+    if (e->length > 0 && fwrite(e->buffer, 1, e->length, e->file) != (size_t) e->length) e->failed = true;
+    e->length = 0;
+}
+
+// Adds formatted text to the buffer, writing the buffer out first if the
+// text might not fit, no more than EXPORTER_LINE_LENGTH at a time
+void Exporter_print(Exporter* e, const char* format, ...) {
+    if (EXPORTER_BUFFER - e->length < EXPORTER_LINE_LENGTH) Exporter_flush(e);
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(e->buffer + e->length, EXPORTER_LINE_LENGTH, format, args);
+    va_end(args);
+    if (written > 0) e->length += written < EXPORTER_LINE_LENGTH ? written : EXPORTER_LINE_LENGTH - 1;
+}
+
+// Opens the file and starts an SVG of the size filled with the colour,
+// returning NULL if the file can't be written
+Exporter* initialiseExporter(const char* file, int width, int height, SDL_Color background) {
+    FILE* f = fopen(file, "wb");
+    if (f == NULL) return NULL;
+    Exporter* e = malloc(sizeof(Exporter));
+    e->file = f;
+    e->failed = false;
+    e->width = width;
+    e->height = height;
+    e->length = 0;
+    e->pending = false;
+    e->open = false;
+    e->path_segments = 0;
+    Exporter_print(e, "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"%d\" height=\"%d\" "
+            "viewBox=\"0 0 %d %d\">\n", width, height, width, height);
+    Exporter_print(e, "<rect width=\"100%%\" height=\"100%%\" fill=\"#%02x%02x%02x\"/>\n",
+            background.r, background.g, background.b);
+    Exporter_print(e, "<g fill=\"none\" stroke-width=\"1\" stroke-linecap=\"square\">\n");
+    return e;
+}
+
+// Checks if two points are close enough to join segments at
+bool Exporter_near(Tuple3* a, Tuple3* b) {
+    return fabs(a->a - b->a) < EXPORTER_JOIN && fabs(a->b - b->b) < EXPORTER_JOIN;
+}
+
+// Ends the path being written
+void Exporter_closePath(Exporter* e) {
+    if (e->open) Exporter_print(e, "\"/>\n");
+    e->open = false;
+}
+
+// Writes the pending segment out, carrying on the path being written if
+// it is the same colour and there is room
+void Exporter_writePending(Exporter* e) {
+    if (!e->pending) return;
+    e->pending = false;
+    SDL_Color c = e->color;
+    if (e->open && (e->path_segments >= EXPORTER_PATH_SEGMENTS || c.r != e->path_color.r
+            || c.g != e->path_color.g || c.b != e->path_color.b || c.a != e->path_color.a)) {
+        Exporter_closePath(e);
+    }
+    if (!e->open) {
+        Exporter_print(e, "<path stroke=\"#%02x%02x%02x\"", c.r, c.g, c.b);
+        if (c.a != 255) Exporter_print(e, " stroke-opacity=\"%.3f\"", c.a / 255.0);
+        Exporter_print(e, " d=\"");
+        e->open = true;
+        e->path_color = c;
+        e->path_segments = 0;
+    } else if (Exporter_near(&e->start, &e->path_end)) {
+        // The segment carries on from the last so only its end is needed
+        Exporter_print(e, " L%.2f %.2f", e->end.a, e->end.b);
+        e->path_end = e->end;
+        e->path_segments++;
+        return;
+    }
+    Exporter_print(e, "%sM%.2f %.2f L%.2f %.2f", e->path_segments > 0 ? " " : "",
+            e->start.a, e->start.b, e->end.a, e->end.b);
+    e->path_end = e->end;
+    e->path_segments++;
+}
+
+// Clips the segment to the canvas, returning false if none of it is on
+// the canvas
+bool Exporter_clip(Exporter* e, Tuple3* a, Tuple3* b) {
+    double t0 = 0, t1 = 1;
+    double dx = b->a - a->a, dy = b->b - a->b;
+    if (!clipLine(a->a, a->b, dx, dy, 0, 0, e->width, e->height, &t0, &t1)) return false;
+    if (!isfinite(t0) || !isfinite(t1)) return false;
+    Tuple3 start = { a->a + t0 * dx, a->b + t0 * dy, a->c };
+    *b = (Tuple3) { a->a + t1 * dx, a->b + t1 * dy, b->c };
+    *a = start;
+    return true;
+}
+
+// Adds a segment between two window coordinates, merging it into the
+// pending segment if it carries on from either end in a straight line
+void Exporter_addLine(Exporter* e, Tuple3* a, Tuple3* b, SDL_Color color) {
+    Tuple3 start = *a, end = *b;
+    if (!Exporter_clip(e, &start, &end)) return;
+    if (e->pending && color.r == e->color.r && color.g == e->color.g
+            && color.b == e->color.b && color.a == e->color.a) {
+        double ux = e->end.a - e->start.a, uy = e->end.b - e->start.b;
+        double vx = end.a - start.a, vy = end.b - start.b;
+        double cross = ux * vy - uy * vx, dot = ux * vx + uy * vy;
+        // Straight enough that the join can't be seen
+        bool straight = fabs(cross) <= EXPORTER_JOIN * sqrt((ux * ux + uy * uy) * (vx * vx + vy * vy));
+        if (straight && dot > 0 && Exporter_near(&start, &e->end)) {
+            e->end = end;
+            return;
+        }
+        if (straight && dot < 0 && Exporter_near(&start, &e->start)) {
+            e->start = end;
+            return;
+        }
+    }
+    Exporter_writePending(e);
+    e->pending = true;
+    e->start = start;
+    e->end = end;
+    e->color = color;
+}
+
+// Writes out what is left and ends the SVG, returning whether all of it
+// was written
+bool Exporter_finish(Exporter* e) {
+    Exporter_writePending(e);
+    Exporter_closePath(e);
+    Exporter_print(e, "</g>\n</svg>\n");
+    Exporter_flush(e);
+    if (fflush(e->file) != 0) e->failed = true;
+    return !e->failed;
+}
+
+void freeExporter(Exporter* e) {
+    fclose(e->file);
+    free(e);
+}
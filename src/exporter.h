@@ -0,0 +1,46 @@
+#ifndef EXPORTER_H_
+#define EXPORTER_H_
+
+// How much of the file is kept before being written out
+#define EXPORTER_BUFFER 65536
+// The most one line of the file can take up
+#define EXPORTER_LINE_LENGTH 128
+// The most segments in one path of the file, so no line of it gets long
+#define EXPORTER_PATH_SEGMENTS 256
+// How close in pixels the ends of two segments are to join them up
+#define EXPORTER_JOIN 0.01
+
+// Writes the segments of a frame straight to an SVG file as they are
+// drawn, dropping what is off the canvas and merging segments that carry
+// on in a straight line, so only the last segment is ever held
+typedef struct Exporter_ {
+
+    FILE* file;
+    bool failed;
+    double width;
+    double height;
+
+    char buffer[EXPORTER_BUFFER];
+    int length;
+
+    // The segment waiting to be merged with the next, if there is one
+    bool pending;
+    Tuple3 start;
+    Tuple3 end;
+    SDL_Color color;
+
+    // The path being written, its colour, where it ended and how many
+    // segments it has
+    bool open;
+    SDL_Color path_color;
+    Tuple3 path_end;
+    int path_segments;
+
+} Exporter;
+
+Exporter* initialiseExporter(const char* file, int width, int height, SDL_Color background);
+void Exporter_addLine(Exporter* e, Tuple3* a, Tuple3* b, SDL_Color color);
+bool Exporter_finish(Exporter* e);
+void freeExporter(Exporter* e);
+
+#endif
@@ -0,0 +1,220 @@
+#include       <math.h>
+#include     <string.h>
+#include     <stdlib.h>
+#include      <ctype.h>
+#include    <stdbool.h>
+#include      "maths.h"
+#include "expression.h"
+
+// What is left of the text being compiled and the expression it goes
+// into, failing if the text is not an expression
+typedef struct Compiler_ {
+    const char* s;
+    Expression* e;
+    bool failed;
+} Compiler;
+
+// The functions an expression can call, in the same order as their
+// operations
+const char* expressionFunctions[] = { "sin", "cos", "tan", "sqrt", "exp", "log", "abs" };
+
+void emitOp(Compiler* c, ExpressionOp op, double constant) {
+    if (c->e->length == EXPRESSION_MAX_OPS) {
+        c->failed = true;
+        return;
+    }
+    c->e->ops[c->e->length] = op;
+    c->e->constants[c->e->length] = constant;
+    c->e->length++;
+}
+
+// Moves past any spaces and returns the next character
+char peekChar(Compiler* c) {
+    while (isspace((unsigned char) *c->s)) c->s++;
+    return *c->s;
+}
+
+void compileSum(Compiler* c);
+void compileUnary(Compiler* c);
+
+// Compiles a number, variable, constant, call or bracketed expression
+void compileAtom(Compiler* c) {
+    char next = peekChar(c);
+    if (next == '(') {
+        c->s++;
+        compileSum(c);
+        if (peekChar(c) == ')') c->s++;
+        else c->failed = true;
+        return;
+    }
+    if (isdigit((unsigned char) next) || next == '.') {
+        char* end;
+        double value = strtod(c->s, &end);
+        if (end == c->s) c->failed = true;
+        c->s = end;
+        emitOp(c, OP_CONSTANT, value);
+        return;
+    }
+    int length = 0;
+    while (isalpha((unsigned char) c->s[length])) length++;
+    if (length == 1 && (next == 'x' || next == 'y' || next == 'z' || next == 't')) {
+        c->s++;
+        if (next == 'x') emitOp(c, OP_X, 0);
+        if (next == 'y') emitOp(c, OP_Y, 0);
+        if (next == 'z') emitOp(c, OP_Z, 0);
+        if (next == 't') emitOp(c, OP_T, 0);
+        return;
+    }
+    if (length == 2 && strncmp(c->s, "pi", 2) == 0) {
+        c->s += 2;
+        emitOp(c, OP_CONSTANT, PI);
+        return;
+    }
+    int functions = sizeof(expressionFunctions) / sizeof(expressionFunctions[0]);
+    for (int i = 0; i < functions; i++) {
+        if (length != (int) strlen(expressionFunctions[i])) continue;
+        if (strncmp(c->s, expressionFunctions[i], length) != 0) continue;
+        c->s += length;
+        if (peekChar(c) != '(') break;
+        compileAtom(c);
+        emitOp(c, OP_SIN + i, 0);
+        return;
+    }
+    c->failed = true;
+}
+
+// Compiles powers, which go from right to left and take a sign after
+// the ^, so -x^-2 is -(x^(-2))
+void compilePower(Compiler* c) {
+    compileAtom(c);
+    if (peekChar(c) != '^') return;
+    c->s++;
+    compileUnary(c);
+    emitOp(c, OP_POWER, 0);
+}
+
+void compileUnary(Compiler* c) {
+    char next = peekChar(c);
+    if (next == '-' || next == '+') {
+        c->s++;
+        compileUnary(c);
+        if (next == '-') emitOp(c, OP_NEGATE, 0);
+        return;
+    }
+    compilePower(c);
+}
+
+void compileProduct(Compiler* c) {
+    compileUnary(c);
+    while (!c->failed && (peekChar(c) == '*' || peekChar(c) == '/')) {
+        char op = *c->s++;
+        compileUnary(c);
+        emitOp(c, op == '*' ? OP_MULTIPLY : OP_DIVIDE, 0);
+    }
+}
+
+void compileSum(Compiler* c) {
+    compileProduct(c);
+    while (!c->failed && (peekChar(c) == '+' || peekChar(c) == '-')) {
+        char op = *c->s++;
+        compileProduct(c);
+        emitOp(c, op == '+' ? OP_ADD : OP_SUBTRACT, 0);
+    }
+}
+
+// Compiles text such as "2*sin(x)-y^2" into an expression, returning
+// false if it is not one or is too long
+bool compileExpression(Expression* e, const char* s) {
+    Compiler c = { s, e, false };
+    e->length = 0;
+    e->variables = 0;
+    compileSum(&c);
+    if (c.failed || peekChar(&c) != '\0') return false;
+    // Check the stack stays small enough to evaluate
+    int depth = 0;
+    for (int i = 0; i < e->length; i++) {
+        ExpressionOp op = e->ops[i];
+        if (op == OP_X) e->variables |= EXPRESSION_X;
+        if (op == OP_Y) e->variables |= EXPRESSION_Y;
+        if (op == OP_Z) e->variables |= EXPRESSION_Z;
+        if (op == OP_T) e->variables |= EXPRESSION_T;
+        if (op <= OP_T) depth++;
+        if (op >= OP_ADD && op <= OP_POWER) depth--;
+        if (depth > EXPRESSION_MAX_DEPTH) return false;
+    }
+    return true;
+}
+
+// Evaluates the expression at n samples all at the time t, running each
+// operation over a chunk of samples at a time rather than every operation
+// for each sample, variables the expression doesn't use can be NULL, the
+// values are kept in the space given
+void Expression_evaluate(Expression* e, double* x, double* y, double* z, double t, double* out, int n, ExpressionStack* space) {
+    double (*stack)[EXPRESSION_CHUNK] = *space;
+    for (int start = 0; start < n; start += EXPRESSION_CHUNK) {
+        int m = n - start < EXPRESSION_CHUNK ? n - start : EXPRESSION_CHUNK;
+        int top = 0;
+        for (int i = 0; i < e->length; i++) {
+            // The value to push to, and the top two values
+            double* d = stack[top];
+            double* a = stack[top > 1 ? top - 2 : 0];
+            double* b = stack[top > 0 ? top - 1 : 0];
+            switch (e->ops[i]) {
+                case OP_CONSTANT:
+                    for (int j = 0; j < m; j++) d[j] = e->constants[i];
+                    top++;
+                break;
+                case OP_X: memcpy(d, x + start, sizeof(double) * m); top++; break;
+                case OP_Y: memcpy(d, y + start, sizeof(double) * m); top++; break;
+                case OP_Z: memcpy(d, z + start, sizeof(double) * m); top++; break;
+                case OP_T: for (int j = 0; j < m; j++) d[j] = t; top++; break;
+                case OP_ADD: for (int j = 0; j < m; j++) a[j] += b[j]; top--; break;
+                case OP_SUBTRACT: for (int j = 0; j < m; j++) a[j] -= b[j]; top--; break;
+                case OP_MULTIPLY: for (int j = 0; j < m; j++) a[j] *= b[j]; top--; break;
+                case OP_DIVIDE: for (int j = 0; j < m; j++) a[j] /= b[j]; top--; break;
+                case OP_POWER: for (int j = 0; j < m; j++) a[j] = pow(a[j], b[j]); top--; break;
+                case OP_NEGATE: for (int j = 0; j < m; j++) b[j] = -b[j]; break;
+                case OP_SIN: for (int j = 0; j < m; j++) b[j] = sin(b[j]); break;
+                case OP_COS: for (int j = 0; j < m; j++) b[j] = cos(b[j]); break;
+                case OP_TAN: for (int j = 0; j < m; j++) b[j] = tan(b[j]); break;
+                case OP_SQRT: for (int j = 0; j < m; j++) b[j] = sqrt(b[j]); break;
+                case OP_EXP: for (int j = 0; j < m; j++) b[j] = exp(b[j]); break;
+                case OP_LOG: for (int j = 0; j < m; j++) b[j] = log(b[j]); break;
+                case OP_ABS: for (int j = 0; j < m; j++) b[j] = fabs(b[j]); break;
+            }
+        }
+        memcpy(out + start, stack[0], sizeof(double) * m);
+    }
+}
+
+// Evaluates the expression at one sample with its stack kept locally, for
+// values evaluated on their own every update
+double Expression_evaluateAt(Expression* e, double x, double y, double z, double t) {
+    double stack[EXPRESSION_MAX_DEPTH];
+    int top = 0;
+    for (int i = 0; i < e->length; i++) {
+        double* a = &stack[top > 1 ? top - 2 : 0];
+        double* b = &stack[top > 0 ? top - 1 : 0];
+        switch (e->ops[i]) {
+            case OP_CONSTANT: stack[top++] = e->constants[i]; break;
+            case OP_X: stack[top++] = x; break;
+            case OP_Y: stack[top++] = y; break;
+            case OP_Z: stack[top++] = z; break;
+            case OP_T: stack[top++] = t; break;
+            case OP_ADD: *a += *b; top--; break;
+            case OP_SUBTRACT: *a -= *b; top--; break;
+            case OP_MULTIPLY: *a *= *b; top--; break;
+            case OP_DIVIDE: *a /= *b; top--; break;
+            case OP_POWER: *a = pow(*a, *b); top--; break;
+            case OP_NEGATE: *b = -*b; break;
+            case OP_SIN: *b = sin(*b); break;
+            case OP_COS: *b = cos(*b); break;
+            case OP_TAN: *b = tan(*b); break;
+            case OP_SQRT: *b = sqrt(*b); break;
+            case OP_EXP: *b = exp(*b); break;
+            case OP_LOG: *b = log(*b); break;
+            case OP_ABS: *b = fabs(*b); break;
+        }
+    }
+    return stack[0];
+}
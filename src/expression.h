@@ -0,0 +1,60 @@
+#ifndef EXPRESSION_H_
+#define EXPRESSION_H_
+
+// The most operations an expression compiles to
+#define EXPRESSION_MAX_OPS 64
+// The most values an expression keeps at once while being evaluated
+#define EXPRESSION_MAX_DEPTH 16
+// How many samples are evaluated together, each operation running over
+// all of them before the next
+#define EXPRESSION_CHUNK 256
+
+// The variables an expression can use, as flags
+#define EXPRESSION_X 1
+#define EXPRESSION_Y 2
+#define EXPRESSION_Z 4
+#define EXPRESSION_T 8
+
+// An operation, each pushing a value or replacing the values on top of
+// the stack with their result
+typedef enum ExpressionOp_ {
+    OP_CONSTANT,
+    OP_X,
+    OP_Y,
+    OP_Z,
+    OP_T,
+    OP_ADD,
+    OP_SUBTRACT,
+    OP_MULTIPLY,
+    OP_DIVIDE,
+    OP_POWER,
+    OP_NEGATE,
+    OP_SIN,
+    OP_COS,
+    OP_TAN,
+    OP_SQRT,
+    OP_EXP,
+    OP_LOG,
+    OP_ABS
+} ExpressionOp;
+
+// An expression of x, y, z and the time t compiled to operations in
+// reverse Polish order
+typedef struct Expression_ {
+    // The variables it uses
+    int variables;
+    int length;
+    ExpressionOp ops[EXPRESSION_MAX_OPS];
+    // The value of each OP_CONSTANT, at the same index
+    double constants[EXPRESSION_MAX_OPS];
+} Expression;
+
+// The values evaluating a chunk of samples keeps at once, kept by the
+// caller so evaluating doesn't allocate
+typedef double ExpressionStack[EXPRESSION_MAX_DEPTH][EXPRESSION_CHUNK];
+
+bool compileExpression(Expression* e, const char* s);
+void Expression_evaluate(Expression* e, double* x, double* y, double* z, double t, double* out, int n, ExpressionStack* space);
+double Expression_evaluateAt(Expression* e, double x, double y, double z, double t);
+
+#endif
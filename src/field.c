@@ -0,0 +1,104 @@
+#include       <SDL.h>
+#include      <math.h>
+#include     <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include   <stdbool.h>
+#include      "main.h"
+#include     "maths.h"
+#include      "item.h"
+#include "expression.h"
+#include     "field.h"
+
+bool fieldEquals(ItemData* a, ItemData* b) {
+    return strcmp(((Field*) a)->source, ((Field*) b)->source) == 0;
+}
+
+// Samples the field again at the time t
+void animateField(ItemData* data, double t, double* values) {
+    Field_sample((Field*) data, t);
+}
+
+void freeField(ItemData* data) {
+    Field* f = (Field*) data;
+    free(f->source);
+    free(f->values);
+    free(f->stack);
+    free(f->vertices);
+    free(f);
+}
+
+// Parses "field fx fy fz [n]" where each component is an expression of x,
+// y, z and t without spaces, returning NULL if it isn't a field
+Field* parseField(const char* s) {
+    // The widths match FIELD_SOURCE_LENGTH
+    char c[3][FIELD_SOURCE_LENGTH + 1];
+    int samples = FIELD_DEFAULT_SAMPLES;
+    if (sscanf(s, "%*s %255s %255s %255s %d", c[0], c[1], c[2], &samples) < 3) return NULL;
+    Field* f = malloc(sizeof(Field));
+    for (int k = 0; k < 3; k++) {
+        if (compileExpression(&f->components[k], c[k])) continue;
+        free(f);
+        return NULL;
+    }
+    if (samples < 2) samples = 2;
+    if (samples > FIELD_MAX_SAMPLES) samples = FIELD_MAX_SAMPLES;
+    f->samples = samples;
+    f->source = malloc(3 * (FIELD_SOURCE_LENGTH + 1) + 16);
+    sprintf(f->source, "%s %s %s %d", c[0], c[1], c[2], samples);
+    SDL_AtomicSet(&f->data.refs, 1);
+    f->data.timed = false;
+    for (int k = 0; k < 3; k++) f->data.timed |= (f->components[k].variables & EXPRESSION_T) != 0;
+    f->data.animate = animateField;
+    f->data.equals = fieldEquals;
+    f->data.free = freeField;
+    // The lattice doesn't change size, so neither does the space for it
+    int n = samples, count = n * n * n;
+    double spacing = 2.0 * AXIS_LENGTH / (n - 1);
+    f->values = malloc(sizeof(double) * 6 * count);
+    f->stack = malloc(sizeof(ExpressionStack));
+    f->vertices = malloc(sizeof(Point) * 4 * count);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            for (int k = 0; k < n; k++) {
+                int s = (i * n + j) * n + k;
+                f->values[s] = -AXIS_LENGTH + i * spacing;
+                f->values[count + s] = -AXIS_LENGTH + j * spacing;
+                f->values[2 * count + s] = -AXIS_LENGTH + k * spacing;
+            }
+        }
+    }
+    f->arrow_count = 0;
+    Field_sample(f, 0);
+    return f;
+}
+
+// Evaluates the field at the time t over the whole lattice at once and
+// builds an arrow at each sample, scaled so the longest reaches most of
+// the way to the next sample, skipping samples where the field is zero
+// or undefined
+void Field_sample(Field* f, double t) {
+    int n = f->samples, count = n * n * n;
+    double spacing = 2.0 * AXIS_LENGTH / (n - 1);
+    double* values = f->values;
+    double* p[3] = { values, values + count, values + 2 * count };
+    double* d[3] = { values + 3 * count, values + 4 * count, values + 5 * count };
+    for (int k = 0; k < 3; k++) Expression_evaluate(&f->components[k], p[0], p[1], p[2], t, d[k], count, f->stack);
+    double longest = 0;
+    for (int s = 0; s < count; s++) {
+        double length = sqrt(d[0][s] * d[0][s] + d[1][s] * d[1][s] + d[2][s] * d[2][s]);
+        if (isfinite(length) && length > longest) longest = length;
+    }
+    f->arrow_count = 0;
+    double scale = longest > 0 ? FIELD_ARROW_SCALE * spacing / longest : 0;
+    for (int s = 0; s < count; s++) {
+        Vector v = { d[0][s] * scale, d[1][s] * scale, d[2][s] * scale };
+        double length = sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+        if (!isfinite(length) || length == 0) continue;
+        // The head is built as the axes' arrows are
+        Point* a = &f->vertices[4 * f->arrow_count++];
+        a[0] = (Point) { p[0][s], p[1][s], p[2][s] };
+        a[1] = (Point) { a[0].x + v.x, a[0].y + v.y, a[0].z + v.z };
+        arrowHead(&a[2], &a[1], &v, FIELD_ARROW_HEAD);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef FIELD_H_
+#define FIELD_H_
+
+// The samples along each side of the lattice when a field doesn't say
+#define FIELD_DEFAULT_SAMPLES 8
+// The most samples along each side of the lattice
+#define FIELD_MAX_SAMPLES 32
+// How long the longest arrow is relative to the spacing of the lattice
+#define FIELD_ARROW_SCALE 0.9
+// How long the lines of an arrow's head are relative to the arrow
+#define FIELD_ARROW_HEAD 0.25
+// The longest text each component of a field can be
+#define FIELD_SOURCE_LENGTH 255
+
+// A vector field sampled on a lattice filling the axis cube, kept as the
+// data of a field item, only the main thread samples it again once it
+// has been parsed
+typedef struct Field_ {
+
+    ItemData data;
+    // The components and samples as written, to tell fields apart
+    char* source;
+    Expression components[3];
+    int samples;
+
+    // The positions then the components of every sample, the positions
+    // set once as the lattice never moves, and the space the components
+    // are evaluated in
+    double* values;
+    ExpressionStack* stack;
+
+    // Each arrow as four vertices, its tail, its tip and the ends of the
+    // two lines of its head
+    int arrow_count;
+    Point* vertices;
+
+} Field;
+
+Field* parseField(const char* s);
+void Field_sample(Field* f, double t);
+
+#endif
@@ -0,0 +1,9 @@
+#ifndef FONT_H_
+#define FONT_H_
+
+// The contents of res/nk57.ttf, which the makefile compiles into the
+// program so the font is found wherever it is run from
+extern unsigned char nk57_ttf[];
+extern unsigned int nk57_ttf_len;
+
+#endif
@@ -0,0 +1,78 @@
+#include    <stdlib.h>
+#include    <string.h>
+#include "gapBuffer.h"
+
+// Sets up an empty gap buffer
+void initialiseGapBuffer(GapBuffer* gb) {
+    gb->capacity = GAPBUFFER_INITIAL_CAPACITY;
+    gb->buffer = malloc(gb->capacity);
+    gb->gap_start = 0;
+    gb->gap_end = gb->capacity;
+}
+
+// Gets the number of characters in the buffer
+int GapBuffer_length(GapBuffer* gb) {
+    return gb->capacity - (gb->gap_end - gb->gap_start);
+}
+
+// Moves the gap so it starts at the position, only the characters
+// between the old and new positions move
+void moveGap(GapBuffer* gb, int position) {
+    if (position < gb->gap_start) {
+        int n = gb->gap_start - position;
+        memmove(gb->buffer + gb->gap_end - n, gb->buffer + position, n);
+        gb->gap_start -= n;
+        gb->gap_end -= n;
+    } else if (position > gb->gap_start) {
+        int n = position - gb->gap_start;
+        memmove(gb->buffer + gb->gap_start, gb->buffer + gb->gap_end, n);
+        gb->gap_start += n;
+        gb->gap_end += n;
+    }
+}
+
+// Makes sure the gap can take n more characters while always leaving
+// room for a null terminator
+void growGap(GapBuffer* gb, int n) {
+    if (gb->gap_end - gb->gap_start > n) return;
+    int length = GapBuffer_length(gb);
+    int capacity = gb->capacity;
+    while (capacity - length <= n) capacity <<= 1;
+    int tail = gb->capacity - gb->gap_end;
+    gb->buffer = realloc(gb->buffer, capacity);
+    memmove(gb->buffer + capacity - tail, gb->buffer + gb->gap_end, tail);
+    gb->gap_end = capacity - tail;
+    gb->capacity = capacity;
+}
+
+// Inserts n characters of s at the position
+void GapBuffer_insert(GapBuffer* gb, int position, const char* s, int n) {
+    growGap(gb, n);
+    moveGap(gb, position);
+    memcpy(gb->buffer + gb->gap_start, s, n);
+    gb->gap_start += n;
+}
+
+// Deletes the n characters from the position onwards
+void GapBuffer_delete(GapBuffer* gb, int position, int n) {
+    moveGap(gb, position);
+    gb->gap_end += n;
+}
+
+// Deletes every character
+void GapBuffer_clear(GapBuffer* gb) {
+    gb->gap_start = 0;
+    gb->gap_end = gb->capacity;
+}
+
+// Gets the characters as a null terminated string by moving the gap to
+// the end, the string is valid until the buffer is next edited
+const char* GapBuffer_string(GapBuffer* gb) {
+    moveGap(gb, GapBuffer_length(gb));
+    gb->buffer[gb->gap_start] = '\0';
+    return gb->buffer;
+}
+
+void freeGapBuffer(GapBuffer* gb) {
+    free(gb->buffer);
+}
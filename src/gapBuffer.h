@@ -0,0 +1,24 @@
+#ifndef GAPBUFFER_H_
+#define GAPBUFFER_H_
+
+// How many bytes a gap buffer starts with
+#define GAPBUFFER_INITIAL_CAPACITY 32
+
+// A line of text with a gap at the last edit, inserting or deleting at
+// the gap costs nothing more than moving the gap there
+typedef struct GapBuffer_ {
+    char* buffer;
+    int capacity;
+    int gap_start;
+    int gap_end;
+} GapBuffer;
+
+void initialiseGapBuffer(GapBuffer* gb);
+int GapBuffer_length(GapBuffer* gb);
+void GapBuffer_insert(GapBuffer* gb, int position, const char* s, int n);
+void GapBuffer_delete(GapBuffer* gb, int position, int n);
+void GapBuffer_clear(GapBuffer* gb);
+const char* GapBuffer_string(GapBuffer* gb);
+void freeGapBuffer(GapBuffer* gb);
+
+#endif
@@ -1,81 +1,205 @@
 #include         <SDL.h>
+#include       <stdio.h>
 #include      <string.h>
 #include     <stdbool.h>
 #include     <SDL_ttf.h>
 #include        "main.h"
+#include   "gapBuffer.h"
 #include "inputWindow.h"
+#include        "font.h"
 
-InputWindow *initialiseInputWindow(SDL_Point p) {
+// Creates the input without anything to show it on, which is all that's
+// needed when nothing is shown
+InputWindow *initialiseInputWindow() {
     InputWindow* iw = malloc(sizeof(InputWindow));
-    iw->window = SDL_CreateWindow(
-            "Input Window",
-            p.x - INPUTWIN_WIDTH - 20,
-            p.y, 
-            INPUTWIN_WIDTH,
-            INPUTWIN_ITEM_HEIGHT * MAX_ITEMS, 
-            0);
-
-    iw->renderer = SDL_CreateRenderer(iw->window, -1, SDL_RENDERER_ACCELERATED);
-    SDL_SetRenderDrawBlendMode(iw->renderer, SDL_BLENDMODE_BLEND);
+    iw->window = NULL;
+    iw->renderer = NULL;
+    iw->font = NULL;
 
     iw->ticks = 0;
     iw->redraw = true;
     iw->component_redraw = true;
 
-    iw->font = TTF_OpenFont("res/nk57.ttf", 24);
-
     iw->caret_index = 0;
     iw->caret_location = 0;
     iw->caret_show = true;
-    for (int i = 0; i < MAX_ITEMS; i++) iw->input[i][0] = '\0';
+    iw->highlight = -1;
+    iw->scroll = 0;
+    for (int i = 0; i < MAX_ITEMS; i++) {
+        initialiseGapBuffer(&iw->input[i]);
+        iw->changed[i] = false;
+    }
     
     return iw;
 }
 
+// Shows the input in a window left of the point, or if a renderer is
+// given draws at the point with that renderer instead of its own window
+void InputWindow_open(InputWindow* iw, SDL_Point p, SDL_Renderer* renderer) {
+    iw->viewport = (SDL_Rect) { 0, 0, INPUTWIN_WIDTH, INPUTWIN_HEIGHT };
+    if (renderer == NULL) {
+        iw->window = SDL_CreateWindow(
+                "Input Window",
+                p.x - INPUTWIN_WIDTH - 20,
+                p.y, 
+                INPUTWIN_WIDTH,
+                INPUTWIN_HEIGHT, 
+                0);
+
+        iw->renderer = SDL_CreateRenderer(iw->window, -1, SDL_RENDERER_ACCELERATED);
+        SDL_SetRenderDrawBlendMode(iw->renderer, SDL_BLENDMODE_BLEND);
+    } else {
+        iw->window = NULL;
+        iw->renderer = renderer;
+        iw->viewport.x = p.x;
+        iw->viewport.y = p.y;
+    }
+    iw->font = TTF_OpenFontRW(SDL_RWFromConstMem(nk57_ttf, nk57_ttf_len), 1, 24);
+    iw->redraw = true;
+}
+
+// Gets the length of the line the caret is on
+int caretLineLength(InputWindow* iw) {
+    return GapBuffer_length(&iw->input[iw->caret_index]);
+}
+
 void collapseCaret(InputWindow* iw) {
-    while (iw->caret_location > strlen(iw->input[iw->caret_index])) {
-        iw->caret_location--;
+    if (iw->caret_location > caretLineLength(iw)) {
+        iw->caret_location = caretLineLength(iw);
+    }
+}
+
+// Scrolls the window so the caret's line can be seen
+void scrollToCaret(InputWindow* iw) {
+    if (iw->caret_index < iw->scroll) iw->scroll = iw->caret_index;
+    if (iw->caret_index >= iw->scroll + INPUTWIN_ROWS) {
+        iw->scroll = iw->caret_index - INPUTWIN_ROWS + 1;
     }
 }
 
-bool isDigit(int i) {
-    if (strlen(SDL_GetKeyName(i)) != 1) return false;
-    return (SDL_GetKeyName(i)[0] - '0') <= ('9' - '0');
+// Marks the line as edited
+void lineChanged(InputWindow* iw, int i) {
+    iw->changed[i] = true;
+    iw->component_redraw = true;
+    iw->redraw = true;
 }
 
-bool isChar(int c) {
-    if (strncmp(SDL_GetKeyName(c), "Space", 5) == 0) return true;
-    if (strlen(SDL_GetKeyName(c)) != 1) return false;
-    return (tolower(SDL_GetKeyName(c)[0]) - 'a') <= ('z' - 'a');
+// Inserts up to n characters at the caret, stopping when the line is full
+void insertRun(InputWindow* iw, const char* s, int n) {
+    GapBuffer* line = &iw->input[iw->caret_index];
+    if (n > MAX_EQUATION_LEN - 1 - GapBuffer_length(line)) n = MAX_EQUATION_LEN - 1 - GapBuffer_length(line);
+    if (n <= 0) return;
+    GapBuffer_insert(line, iw->caret_location, s, n);
+    iw->caret_location += n;
+}
+
+// Inserts up to n characters at the caret, skipping any that cannot be
+// drawn and stopping when the line is full, tabs and carriage returns
+// that don't end the text separate values so become spaces
+void insertAtCaret(InputWindow* iw, const char* s, int n) {
+    int start = 0;
+    for (int i = 0; i <= n; i++) {
+        // Insert the runs of printable characters in one go
+        if (i < n && s[i] >= ' ' && s[i] <= '~') continue;
+        insertRun(iw, s + start, i - start);
+        if (i < n && (s[i] == '\t' || (s[i] == '\r' && i < n - 1))) insertRun(iw, " ", 1);
+        start = i + 1;
+    }
+    lineChanged(iw, iw->caret_index);
 }
 
 // React to mouse motion
 void InputWindow_mouseMotionEvent(InputWindow* iw, SDL_MouseMotionEvent e) {
+    // Highlight the item under the mouse if there is one
+    int i = iw->scroll + e.y / INPUTWIN_ITEM_HEIGHT;
+    if (e.y < 0 || i >= MAX_ITEMS || GapBuffer_length(&iw->input[i]) == 0) i = -1;
+    InputWindow_setHighlight(iw, i);
 }
 
 // React to mouse button presses
 void InputWindow_mouseButtonEvent(InputWindow* iw, SDL_MouseButtonEvent e) {
 }
 
+// Scroll through the items
+void InputWindow_mouseWheelEvent(InputWindow* iw, SDL_MouseWheelEvent e) {
+    iw->scroll -= e.y;
+    if (iw->scroll > MAX_ITEMS - INPUTWIN_ROWS) iw->scroll = MAX_ITEMS - INPUTWIN_ROWS;
+    if (iw->scroll < 0) iw->scroll = 0;
+    iw->redraw = true;
+}
+
+// React to typed text
+void InputWindow_textEvent(InputWindow* iw, SDL_TextInputEvent e) {
+    collapseCaret(iw);
+    insertAtCaret(iw, e.text, strlen(e.text));
+}
+
+// Inserts text at the caret, each new line of the text goes into a new
+// item after the caret's, pushing the items below further down, lines
+// that would push items off the end are left out
+void InputWindow_paste(InputWindow* iw, const char* text) {
+    collapseCaret(iw);
+    int lines = 0;
+    for (const char* c = text; *c != '\0'; c++) {
+        if (*c == '\n') lines++;
+    }
+    // Only the empty items at the end can be pushed off
+    int used = MAX_ITEMS;
+    while (used > iw->caret_index + 1 && GapBuffer_length(&iw->input[used - 1]) == 0) used--;
+    if (lines > MAX_ITEMS - used) {
+        printf("Only %d of the %d pasted lines fit, the rest were left out\n", MAX_ITEMS - used + 1, lines + 1);
+        lines = MAX_ITEMS - used;
+    }
+    if (lines > 0) {
+        // Make room for the new items in one move, only empty items fall
+        // off the end
+        int first = iw->caret_index + 1;
+        for (int i = MAX_ITEMS - lines; i < MAX_ITEMS; i++) freeGapBuffer(&iw->input[i]);
+        memmove(&iw->input[first + lines], &iw->input[first],
+                sizeof(GapBuffer) * (MAX_ITEMS - lines - first));
+        for (int i = first; i < first + lines; i++) initialiseGapBuffer(&iw->input[i]);
+        // Past the items that moved down everything was and stays empty
+        for (int i = first; i < used + lines; i++) lineChanged(iw, i);
+        // The text after the caret moves to the end of the last new item
+        GapBuffer* line = &iw->input[iw->caret_index];
+        const char* rest = GapBuffer_string(line) + iw->caret_location;
+        GapBuffer_insert(&iw->input[first + lines - 1], 0, rest, strlen(rest));
+        GapBuffer_delete(line, iw->caret_location, strlen(rest));
+    }
+    // Insert each line of the text, the first at the caret
+    for (int i = 0; i <= lines; i++) {
+        const char* end = strchr(text, '\n');
+        if (end == NULL) end = text + strlen(text);
+        insertAtCaret(iw, text, end - text);
+        if (i == lines) break;
+        text = end + 1;
+        iw->caret_index++;
+        iw->caret_location = 0;
+    }
+    scrollToCaret(iw);
+}
+
+// Gets the text of an item
+const char* InputWindow_getLine(InputWindow* iw, int i) {
+    return GapBuffer_string(&iw->input[i]);
+}
+
 // React to key presses
 void InputWindow_keyEvent(InputWindow* iw, SDL_KeyboardEvent e) {
-    const Uint8* keystate = SDL_GetKeyboardState(NULL);
-    if (e.type == SDL_KEYDOWN) {
-        if (isChar(e.keysym.sym) || isDigit(e.keysym.sym)) {
-            if (strlen(iw->input[iw->caret_index]) < MAX_EQUATION_LEN - 1) {
-                iw->input[iw->caret_index][strlen(iw->input[iw->caret_index]) + 1] = '\0';
-                for (int i = strlen(iw->input[iw->caret_index]); i > iw->caret_location; i--) {
-                    iw->input[iw->caret_index][i] = iw->input[iw->caret_index][i - 1];
-                }
-                iw->input[iw->caret_index][iw->caret_location] = e.keysym.sym;
-                iw->caret_location++;
-                iw->component_redraw = true;
-            }
+    // Taken from the event rather than the keyboard so replays match
+    bool shift = (e.keysym.mod & KMOD_LSHIFT) != 0;
+    // Paste from the clipboard
+    if (e.type == SDL_KEYDOWN && e.keysym.sym == SDLK_v && (e.keysym.mod & KMOD_CTRL)) {
+        char* text = SDL_GetClipboardText();
+        if (text != NULL) {
+            InputWindow_paste(iw, text);
+            SDL_free(text);
         }
+        return;
     }
     switch (e.keysym.sym) {
         case SDLK_LEFT:
-            if (keystate[SDL_SCANCODE_LSHIFT]) {
+            if (shift) {
                 iw->caret_location = 0;
                 iw->redraw = true;
                 break;
@@ -86,19 +210,19 @@ void InputWindow_keyEvent(InputWindow* iw, SDL_KeyboardEvent e) {
                     iw->caret_location--;
                     iw->redraw = true;
                 } else {
-                    iw->caret_location = strlen(iw->input[iw->caret_index]);
+                    iw->caret_location = caretLineLength(iw);
                     iw->redraw = true;
                 }
             }  
         break;
         case SDLK_RIGHT:
-            if (keystate[SDL_SCANCODE_LSHIFT]) {
-                iw->caret_location = strlen(iw->input[iw->caret_index]);
+            if (shift) {
+                iw->caret_location = caretLineLength(iw);
                 iw->redraw = true;
                 break;
             }
             if (e.type == SDL_KEYDOWN) {
-                if (iw->caret_location < strlen(iw->input[iw->caret_index])) {
+                if (iw->caret_location < caretLineLength(iw)) {
                     iw->caret_location++;
                     iw->redraw = true;
                 } else {
@@ -112,6 +236,7 @@ void InputWindow_keyEvent(InputWindow* iw, SDL_KeyboardEvent e) {
                 if (iw->caret_index > 0) {
                     iw->caret_index--;
                     collapseCaret(iw);
+                    scrollToCaret(iw);
                     iw->redraw = true;
                 }
             }
@@ -122,39 +247,30 @@ void InputWindow_keyEvent(InputWindow* iw, SDL_KeyboardEvent e) {
                 if (iw->caret_index < MAX_ITEMS - 1) {
                     iw->caret_index++;
                     collapseCaret(iw);
+                    scrollToCaret(iw);
                     iw->redraw = true;
                 }
             }
         break;
         case SDLK_BACKSPACE:
-            if (keystate[SDL_SCANCODE_LSHIFT]) {
-                strcpy(iw->input[iw->caret_index], "\0");
+            if (shift) {
+                GapBuffer_clear(&iw->input[iw->caret_index]);
                 iw->caret_location = 0;
-                iw->redraw = true;
+                lineChanged(iw, iw->caret_index);
                 break;
             }
+            collapseCaret(iw);
             if (iw->caret_location == 0) break;
             if (e.type == SDL_KEYDOWN) {
-                int new_len = strlen(iw->input[iw->caret_index]);
-                char sub[new_len];
-                for (int i = 0; i < new_len; i++) {
-                    if (i == iw->caret_location - 1) continue;
-                    if (i < iw->caret_location - 1) {
-                        sub[i] = iw->input[iw->caret_index][i];
-                    } else {
-                        sub[i - 1] = iw->input[iw->caret_index][i];
-                    }
-                }
-                sub[new_len - 1] = '\0';
-                strcpy(iw->input[iw->caret_index], sub);
                 iw->caret_location--;
-                iw->component_redraw = true;
+                GapBuffer_delete(&iw->input[iw->caret_index], iw->caret_location, 1);
+                lineChanged(iw, iw->caret_index);
             }
         break;
     }
 }
 
-SDL_Texture* createText(char* title, int* w, int* h, SDL_Color c, InputWindow* iw) {
+SDL_Texture* createText(const char* title, int* w, int* h, SDL_Color c, InputWindow* iw) {
     SDL_Surface* surface = TTF_RenderText_Solid(iw->font, title, c);
     SDL_Texture* t = SDL_CreateTextureFromSurface(iw->renderer, surface);
     SDL_FreeSurface(surface);
@@ -162,7 +278,7 @@ SDL_Texture* createText(char* title, int* w, int* h, SDL_Color c, InputWindow* i
     return t;
 }
 
-int caretLocation(char* title, int caret_location, InputWindow* iw) {
+int caretLocation(const char* title, int caret_location, InputWindow* iw) {
     if (caret_location == 0) return 0;
     if (caret_location > strlen(title)) caret_location = strlen(title);
     int loc;
@@ -174,8 +290,15 @@ int caretLocation(char* title, int caret_location, InputWindow* iw) {
     return loc;
 }
 
+// Draws the items, then shows them if the input window has its own
+// window, otherwise whoever owns the renderer presents them
 void drawInputWindow(InputWindow* iw) {
-    SDL_RenderClear(iw->renderer);
+    iw->redraw = false;
+    if (iw->window == NULL) {
+        SDL_RenderSetViewport(iw->renderer, &iw->viewport);
+    } else {
+        SDL_RenderClear(iw->renderer);
+    }
 
     SDL_SetRenderDrawColor(iw->renderer, BG_R, BG_G, BG_B, 255);
     SDL_RenderFillRect(iw->renderer, NULL);
@@ -188,11 +311,17 @@ void drawInputWindow(InputWindow* iw) {
     SDL_Rect srcrect = { 0, 0, 0, 0 };
     SDL_Rect dstrect = { ITEM_BUFFER, 0, INPUTWIN_WIDTH, 0 };
     SDL_SetRenderDrawColor(iw->renderer, 255, 255, 255, 128);
-    for (int i = 0; i < MAX_ITEMS; i++) {
-        
-        dstrect.y = i * INPUTWIN_ITEM_HEIGHT;
+    for (int i = iw->scroll; i < iw->scroll + INPUTWIN_ROWS; i++) {
+        const char* line = InputWindow_getLine(iw, i);
+        dstrect.y = (i - iw->scroll) * INPUTWIN_ITEM_HEIGHT;
+        if (iw->highlight == i) {
+            SDL_Rect highlight = { 0, dstrect.y, INPUTWIN_WIDTH, INPUTWIN_ITEM_HEIGHT };
+            SDL_SetRenderDrawColor(iw->renderer, 255, 255, 255, 32);
+            SDL_RenderFillRect(iw->renderer, &highlight);
+            SDL_SetRenderDrawColor(iw->renderer, 255, 255, 255, 128);
+        }
         if (iw->caret_index == i && iw->caret_show) {
-            loc = caretLocation(iw->input[i], iw->caret_location, iw);
+            loc = caretLocation(line, iw->caret_location, iw);
             SDL_RenderDrawLine(iw->renderer,
                     dstrect.x + loc,
                     dstrect.y + caret_buffer,
@@ -200,8 +329,8 @@ void drawInputWindow(InputWindow* iw) {
                     dstrect.y + caret_buffer + CARET_HEIGHT);
         }
 
-        if (strncmp(iw->input[i], "", 1) == 0) continue;
-        text = createText(iw->input[i], &w, &h, c, iw);
+        if (strncmp(line, "", 1) == 0) continue;
+        text = createText(line, &w, &h, c, iw);
         if (w < INPUTWIN_WIDTH) { 
             srcrect.w = w;
         } else { srcrect.w = INPUTWIN_WIDTH; }
@@ -214,12 +343,16 @@ void drawInputWindow(InputWindow* iw) {
     }
 
     int line_end_x = INPUTWIN_WIDTH - SEP_BUFFER;
-    for (int i = 1; i < MAX_ITEMS; i++) {
+    for (int i = 1; i < INPUTWIN_ROWS; i++) {
         SDL_RenderDrawLine(iw->renderer, SEP_BUFFER, i * INPUTWIN_ITEM_HEIGHT,
                 line_end_x, i * INPUTWIN_ITEM_HEIGHT);
     }
 
-    SDL_RenderPresent(iw->renderer);
+    if (iw->window == NULL) {
+        SDL_RenderSetViewport(iw->renderer, NULL);
+    } else {
+        SDL_RenderPresent(iw->renderer);
+    }
 }
 
 void updateInputWindow(InputWindow* iw) {
@@ -238,9 +371,45 @@ bool InputWindow_dropRedraw(InputWindow* iw) {
     return false;
 }
 
+// Checks if the line has been edited since this was last called for it
+bool InputWindow_dropChanged(InputWindow* iw, int i) {
+    if (iw->changed[i]) {
+        iw->changed[i] = false;
+        return true;
+    }
+    return false;
+}
+
+// Highlights the item, or nothing if it is -1
+void InputWindow_setHighlight(InputWindow* iw, int i) {
+    if (iw->highlight == i) return;
+    iw->highlight = i;
+    iw->redraw = true;
+}
+
+// Fills the items with the lines of a file, returning whether it could
+// be read
+bool InputWindow_load(InputWindow* iw, const char* file) {
+    FILE* f = fopen(file, "r");
+    if (f == NULL) return false;
+    char line[MAX_EQUATION_LEN];
+    for (int i = 0; i < MAX_ITEMS && fgets(line, MAX_EQUATION_LEN, f) != NULL; i++) {
+        line[strcspn(line, "\r\n")] = '\0';
+        GapBuffer_clear(&iw->input[i]);
+        GapBuffer_insert(&iw->input[i], 0, line, strlen(line));
+        lineChanged(iw, i);
+    }
+    fclose(f);
+    return true;
+}
+
 void freeInputWindow(InputWindow* iw) {
-    TTF_CloseFont(iw->font);
-    SDL_DestroyRenderer(iw->renderer);
-    SDL_DestroyWindow(iw->window);
+    for (int i = 0; i < MAX_ITEMS; i++) freeGapBuffer(&iw->input[i]);
+    if (iw->font != NULL) TTF_CloseFont(iw->font);
+    // A shared renderer is freed by its owner
+    if (iw->window != NULL) {
+        SDL_DestroyRenderer(iw->renderer);
+        SDL_DestroyWindow(iw->window);
+    }
     free(iw);
 }
@@ -3,8 +3,13 @@
 
 #define INPUTWIN_WIDTH       320
 #define INPUTWIN_ITEM_HEIGHT 40
+#define INPUTWIN_ROWS        16
+#define INPUTWIN_HEIGHT      (INPUTWIN_ITEM_HEIGHT * INPUTWIN_ROWS)
 
-#define MAX_ITEMS            16
+// How many lines there can be, enough to paste long lists of items
+// into, scenes keep how many of them are used so the items are only
+// copied and drawn up to the last line that isn't empty
+#define MAX_ITEMS            4096
 #define MAX_EQUATION_LEN     512
 
 #define CARET_HEIGHT         24
@@ -17,24 +22,39 @@ typedef struct InputWindow_ {
     bool redraw;
     bool component_redraw;
 
+    // The window is NULL when drawing into part of another window's
+    // renderer, the viewport is where it draws, and all three are NULL
+    // until the input is opened
     SDL_Window* window;
     SDL_Renderer* renderer;
+    SDL_Rect viewport;
     TTF_Font* font;
 
     int caret_index;
     int caret_location;
     bool caret_show;
-    char input[MAX_ITEMS][MAX_EQUATION_LEN];
+    int highlight;
+    int scroll;
+    GapBuffer input[MAX_ITEMS];
+    bool changed[MAX_ITEMS];
 
 } InputWindow;
 
-InputWindow* initialiseInputWindow(SDL_Point p);
+InputWindow* initialiseInputWindow();
+void InputWindow_open(InputWindow* iw, SDL_Point p, SDL_Renderer* renderer);
 void InputWindow_mouseMotionEvent(InputWindow* iw, SDL_MouseMotionEvent e);
 void InputWindow_mouseButtonEvent(InputWindow* iw, SDL_MouseButtonEvent e);
+void InputWindow_mouseWheelEvent(InputWindow* iw, SDL_MouseWheelEvent e);
 void InputWindow_keyEvent(InputWindow* iw, SDL_KeyboardEvent e);
+void InputWindow_textEvent(InputWindow* iw, SDL_TextInputEvent e);
+void InputWindow_paste(InputWindow* iw, const char* text);
+const char* InputWindow_getLine(InputWindow* iw, int i);
 void drawInputWindow(InputWindow* iw);
 void updateInputWindow(InputWindow* iw);
 bool InputWindow_dropRedraw(InputWindow* iw);
+bool InputWindow_dropChanged(InputWindow* iw, int i);
+void InputWindow_setHighlight(InputWindow* iw, int i);
+bool InputWindow_load(InputWindow* iw, const char* file);
 void freeInputWindow(InputWindow* iw);
 
 #endif
@@ -0,0 +1,145 @@
+#include       <SDL.h>
+#include      <math.h>
+#include    <stdlib.h>
+#include   <stdbool.h>
+#include     "maths.h"
+#include      "item.h"
+#include "intersect.h"
+
+void initialiseIntersections(Intersections* in) {
+    initialiseSystems3(&in->systems);
+    in->point_count = 0;
+    in->point_capacity = 0;
+    in->points = NULL;
+    in->line_count = 0;
+    in->line_capacity = 0;
+    in->line_points = NULL;
+    in->line_vectors = NULL;
+}
+
+// Solves the batch, keeping the solutions as points
+void flushPoints(Intersections* in) {
+    Systems3* s = &in->systems;
+    Systems3_solve(s);
+    for (int i = 0; i < s->count; i++) {
+        if (s->singular[i]) continue;
+        if (in->point_count == in->point_capacity) {
+            in->point_capacity = in->point_capacity == 0 ? 64 : in->point_capacity * 2;
+            in->points = realloc(in->points, sizeof(Point) * in->point_capacity);
+        }
+        in->points[in->point_count++] = (Point) { s->x[0][i], s->x[1][i], s->x[2][i] };
+    }
+    s->count = 0;
+}
+
+// Solves the batch, keeping the solutions as points on lines going in
+// the batch's directions
+void flushLines(Intersections* in) {
+    Systems3* s = &in->systems;
+    Systems3_solve(s);
+    for (int i = 0; i < s->count; i++) {
+        if (s->singular[i]) continue;
+        if (in->line_count == in->line_capacity) {
+            in->line_capacity = in->line_capacity == 0 ? 64 : in->line_capacity * 2;
+            in->line_points = realloc(in->line_points, sizeof(Point) * in->line_capacity);
+            in->line_vectors = realloc(in->line_vectors, sizeof(Vector) * in->line_capacity);
+        }
+        in->line_points[in->line_count] = (Point) { s->x[0][i], s->x[1][i], s->x[2][i] };
+        in->line_vectors[in->line_count] = in->directions[i];
+        in->line_count++;
+    }
+    s->count = 0;
+}
+
+// Adds the system with the three planes as rows, each a normal followed
+// by a constant
+void addSystem(Intersections* in, double* a, double* b, double* c) {
+    double m[9] = { a[0], a[1], a[2], b[0], b[1], b[2], c[0], c[1], c[2] };
+    double r[3] = { a[3], b[3], c[3] };
+    Systems3_add(&in->systems, m, r);
+}
+
+// Finds where every pair of planes meets in a line, and where every line
+// and plane or three planes meet in a point, skipping those that are
+// parallel
+void findIntersections(Intersections* in, Item* items, int count) {
+    in->point_count = 0;
+    in->line_count = 0;
+    in->systems.count = 0;
+    // Each plane as a normal and constant, and each line as two planes
+    // that meet along it
+    int planes = 0, lines = 0;
+    for (int i = 0; i < count; i++) {
+        if (items[i].type == ITEM_PLANE) planes++;
+        if (items[i].type == ITEM_LINE) lines++;
+    }
+    double (*plane)[4] = malloc(sizeof(double[4]) * (planes + 1));
+    double (*line)[4] = malloc(sizeof(double[4]) * (2 * lines + 1));
+    planes = 0;
+    lines = 0;
+    for (int i = 0; i < count; i++) {
+        double* v = items[i].values;
+        if (items[i].type == ITEM_PLANE) {
+            for (int j = 0; j < 4; j++) plane[planes][j] = v[j];
+            planes++;
+        }
+        if (items[i].type == ITEM_LINE) {
+            Vector d = { v[3], v[4], v[5] };
+            if (d.x == 0 && d.y == 0 && d.z == 0) continue;
+            // Cross with the axis least in line with the direction
+            Vector axis = { 0, 0, 1 }, u, w;
+            if (fabs(d.x) <= fabs(d.y) && fabs(d.x) <= fabs(d.z)) axis = (Vector) { 1, 0, 0 };
+            else if (fabs(d.y) <= fabs(d.z)) axis = (Vector) { 0, 1, 0 };
+            crossVector(&u, &d, &axis);
+            crossVector(&w, &d, &u);
+            line[lines][0] = u.x;
+            line[lines][1] = u.y;
+            line[lines][2] = u.z;
+            line[lines][3] = u.x * v[0] + u.y * v[1] + u.z * v[2];
+            line[lines + 1][0] = w.x;
+            line[lines + 1][1] = w.y;
+            line[lines + 1][2] = w.z;
+            line[lines + 1][3] = w.x * v[0] + w.y * v[1] + w.z * v[2];
+            lines += 2;
+        }
+    }
+    // Two planes meet along their normals' cross product, the point on it
+    // closest to the origin is found with a third plane through the
+    // origin along it
+    for (int i = 0; i < planes; i++) {
+        for (int j = i + 1; j < planes; j++) {
+            Vector a = { plane[i][0], plane[i][1], plane[i][2] };
+            Vector b = { plane[j][0], plane[j][1], plane[j][2] };
+            Vector* d = &in->directions[in->systems.count];
+            crossVector(d, &a, &b);
+            double through[4] = { d->x, d->y, d->z, 0 };
+            addSystem(in, plane[i], plane[j], through);
+            if (in->systems.count == INTERSECT_BATCH) flushLines(in);
+        }
+    }
+    flushLines(in);
+    for (int i = 0; i < lines; i += 2) {
+        for (int j = 0; j < planes; j++) {
+            addSystem(in, line[i], line[i + 1], plane[j]);
+            if (in->systems.count == INTERSECT_BATCH) flushPoints(in);
+        }
+    }
+    for (int i = 0; i < planes; i++) {
+        for (int j = i + 1; j < planes; j++) {
+            for (int k = j + 1; k < planes; k++) {
+                addSystem(in, plane[i], plane[j], plane[k]);
+                if (in->systems.count == INTERSECT_BATCH) flushPoints(in);
+            }
+        }
+    }
+    flushPoints(in);
+    free(plane);
+    free(line);
+}
+
+void freeIntersections(Intersections* in) {
+    freeSystems3(&in->systems);
+    free(in->points);
+    free(in->line_points);
+    free(in->line_vectors);
+}
@@ -0,0 +1,30 @@
+#ifndef INTERSECT_H_
+#define INTERSECT_H_
+
+// How many systems are solved at once, which keeps the memory they take
+// bounded however many items there are
+#define INTERSECT_BATCH 4096
+
+// Where the lines and planes of a scene meet
+typedef struct Intersections_ {
+
+    Systems3 systems;
+    // The directions of the lines the batch's systems are points on
+    Vector directions[INTERSECT_BATCH];
+
+    int point_count;
+    int point_capacity;
+    Point* points;
+
+    int line_count;
+    int line_capacity;
+    Point* line_points;
+    Vector* line_vectors;
+
+} Intersections;
+
+void initialiseIntersections(Intersections* in);
+void findIntersections(Intersections* in, Item* items, int count);
+void freeIntersections(Intersections* in);
+
+#endif
@@ -0,0 +1,55 @@
+#include        <SDL.h>
+#include      <stdio.h>
+#include     <string.h>
+#include    <stdbool.h>
+#include      "maths.h"
+#include       "item.h"
+#include "expression.h"
+#include  "animation.h"
+#include    "command.h"
+
+// Parses a line of input into an item, anything that is not a known
+// command parses to an item of type ITEM_NONE, the item must be released
+// when it is finished with
+void parseItem(Item* item, const char* s) {
+    char name[16];
+    item->type = ITEM_NONE;
+    item->command = NULL;
+    item->data = NULL;
+    for (int i = 0; i < MAX_ITEM_VALUES; i++) item->values[i] = 0;
+    if (sscanf(s, "%15s", name) != 1) return;
+    const Command* c = findCommand(name);
+    if (c == NULL) return;
+    if (c->parse != NULL) {
+        item->data = c->parse(s);
+        if (item->data == NULL) return;
+    } else {
+        // Values the command does not use are left as zero so they don't
+        // make items differ, any that change with time are kept as data
+        item->data = (ItemData*) parseValues(s, c->values, item->values);
+    }
+    item->type = c->type;
+    item->command = c;
+}
+
+// Checks if two items draw the same geometry
+bool itemEquals(Item* a, Item* b) {
+    if (a->type != b->type) return false;
+    for (int i = 0; i < MAX_ITEM_VALUES; i++) {
+        if (a->values[i] != b->values[i]) return false;
+    }
+    if (a->data == b->data) return true;
+    if (a->data == NULL || b->data == NULL) return false;
+    return a->data->equals(a->data, b->data);
+}
+
+// Keeps the item's data for another copy of the item
+void retainItem(Item* item) {
+    if (item->data != NULL) SDL_AtomicIncRef(&item->data->refs);
+}
+
+// Lets go of the item's data, freeing it if no copies are left
+void releaseItem(Item* item) {
+    if (item->data != NULL && SDL_AtomicDecRef(&item->data->refs)) item->data->free(item->data);
+    item->data = NULL;
+}
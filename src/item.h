@@ -0,0 +1,52 @@
+#ifndef ITEM_H_
+#define ITEM_H_
+
+// The most values an item takes after its name
+#define MAX_ITEM_VALUES 7
+
+// Defines what an item draws
+typedef enum ItemType_ {
+    ITEM_NONE,
+    ITEM_PLANE,
+    ITEM_POINT,
+    ITEM_LINE,
+    ITEM_INTERSECT,
+    ITEM_SPHERE,
+    ITEM_ELLIPSOID,
+    ITEM_CYLINDER,
+    ITEM_FIELD,
+    ITEM_SCATTER,
+    ITEM_PATH
+} ItemType;
+
+// What an item keeps besides its values, such as compiled expressions,
+// shared by every scene the item is in and freed when the last of them
+// lets go of it, each kind of data starts with this
+typedef struct ItemData_ {
+    SDL_atomic_t refs;
+    // Whether what the item draws changes with the time t
+    bool timed;
+    // Brings the data up to the time t, and the item's values into the
+    // array, only called by the main thread and only if it is timed
+    void (*animate)(struct ItemData_* data, double t, double* values);
+    // Whether two of this kind of data draw the same geometry
+    bool (*equals)(struct ItemData_* a, struct ItemData_* b);
+    void (*free)(struct ItemData_* data);
+} ItemData;
+
+// Defines a graph item parsed from a line of input
+typedef struct Item_ {
+    ItemType type;
+    double values[MAX_ITEM_VALUES];
+    // The command the item was typed as, or NULL
+    const struct Command_* command;
+    // Anything else the item keeps, or NULL
+    ItemData* data;
+} Item;
+
+void parseItem(Item* item, const char* s);
+bool itemEquals(Item* a, Item* b);
+void retainItem(Item* item);
+void releaseItem(Item* item);
+
+#endif
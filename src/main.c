@@ -6,7 +6,25 @@
 #include        "main.h"
 #include       "maths.h"
 #include      "memory.h"
+#include        "item.h"
+#include   "gapBuffer.h"
 #include "inputWindow.h"
+#include  "threadPool.h"
+#include  "rasteriser.h"
+#include      "picker.h"
+#include    "recorder.h"
+#include   "intersect.h"
+#include       "scene.h"
+#include        "mesh.h"
+#include  "expression.h"
+#include       "field.h"
+#include       "cloud.h"
+#include     "command.h"
+#include   "viewCache.h"
+#include      "bounds.h"
+#include    "exporter.h"
+#include     "density.h"
+#include      "stream.h"
 
 //
 //      GLOBAL VARIABLES
@@ -23,11 +41,90 @@ SDL_Window* window = NULL;
 SDL_Renderer* renderer = NULL;
 // The window where the user can input information
 InputWindow* inputWindow = NULL;
+// Whether the input is a panel in the graph's window instead of its own
+bool single = false;
+// In single window mode the graph is drawn into this, so the panel can
+// redraw without the graph
+SDL_Texture* graphTexture = NULL;
 // The vector pointing to the view and the axes
 PolarVector* view = NULL;
+// The length of the axes, which fitting the view to the scene changes
+double axisLength = AXIS_LENGTH;
+// The threads shared by the rasteriser, the density map and the bounds
+// of big items, so there is one worker per core however many use them
+ThreadPool* threadPool = NULL;
+// The basis points are projected onto and the view it was made for
+ViewBasis viewBasis;
+PolarVector basisView = { -1, 0, 0 };
+// Whether the graph is drawn by the depth buffered software rasteriser
+bool rasterise = false;
+// The software rasteriser, created when first needed
+Rasteriser* rasteriser = NULL;
+// Whether the graph is split into top, front, side and free views
+bool views = false;
+// The segments of a frame when the graph is split, and whether drawing
+// goes into it instead of to the screen
+ViewCache* viewCache = NULL;
+bool capturing = false;
+// The directions in the graph that go right and up in each split view
+Vector splitAxes[SPLIT_VIEWS][2];
+// Where the segments of a frame go instead of the screen while it is
+// being exported
+Exporter* exporter = NULL;
+// Whether the graph should be exported when it is next drawn
+bool exportWanted = false;
+// The colour being drawn with
+SDL_Color drawColor;
+// The segments drawn on the graph, for finding what is under the mouse
+Picker* picker = NULL;
+// The unit meshes every sphere, ellipsoid and cylinder is drawn from,
+// made when first needed
+MeshSet* meshes = NULL;
+// Space for the window coordinates of a batch of points
+Tuple3* batch = NULL;
+int batchCapacity = 0;
+// The time t in seconds that animated items are drawn at, advancing with
+// each update so replays see the same times
+double animationTime = 0;
+// The drawn scene's items with the values of those that change with time
+// moved on to the animation time, only used by the main thread as the
+// worker copies its next scene from the drawn one, and which scene they
+// were copied from by its swap, only the scene's used items are copied
+// so loops over them stop at its count
+Item drawnItems[MAX_ITEMS];
+int drawnCount = 0;
+unsigned long drawnSwaps = (unsigned long) -1;
+// Big items only draw every strata-th of their points from stratum on,
+// and how many of the strata the graph has drawn so far and whether it
+// still has more to draw in later frames
+int stratum = 0;
+int strata = 1;
+int drawnStrata = 0;
+bool refining = false;
+// Whether scatters are drawn as how many points land on each pixel, the
+// counts they are splatted into, made when first needed, and whether the
+// scene being drawn splats its scatters
+bool densityMode = false;
+DensityMap* density = NULL;
+bool splatting = false;
+// The records read with -stream, or NULL if there is no stream
+Stream* stream = NULL;
+// The item being drawn, or -1 for the axes
+int drawingItem = -1;
+// The item under the mouse, or -1 if there is none
+int hoveredItem = -1;
+// Whether to print how long each part of start up takes, and when the
+// last part finished
+bool startupProfile = false;
+Uint64 startupStart = 0;
+Uint64 startupLast = 0;
+// Records the events or replays them, if either was asked for
+Recorder* recorder = NULL;
 
 // The array of colours for graph items
 SDL_Color colors[MAX_ITEMS];
+// Parses the lines of the input into the scene of items that is drawn
+SceneBuilder* sceneBuilder = NULL;
 
 // Whether the left mouse button is held down
 bool leftMouseDown;
@@ -52,18 +149,19 @@ bool isMouseFocused(SDL_Window* w) {
 //      RENDERING FUNCTIONS
 //
 
-// Gets the projected x, y screen coordinates of a 3D point
-void coordinatesTo(Tuple2* t, Point* p) {
+// Projects a point from the given view by solving for it in the view's
+// basis, this is what projectTo has to match and is kept for checking it
+void referenceProjectTo(Tuple3* t, PolarVector* pv, Point* p) {
     Vector v, u, w;
     Plane viewPlane;
     Tuple3 coeffs;
 
     // Gets the cartesian vector from the view point
-    vectorFromPolar(&v, view);
+    vectorFromPolar(&v, pv);
     // Gets the plane normal to the view vector and moves it to the end
     // of the vector
     normalPlane(&viewPlane, &v);
-    viewPlane.constant = view->r;
+    viewPlane.constant = pv->r;
 
     // Gets the orthonormals of the plane
     // one of which is in the plane spanned by the z axis and the view
@@ -75,12 +173,95 @@ void coordinatesTo(Tuple2* t, Point* p) {
     // Put the coefficients into the tuple
     t->a = coeffs.c;
     t->b = -coeffs.b;
+    t->c = coeffs.a * pv->r;
+}
+
+// Remakes the basis points are projected onto if the view has changed
+void updateViewBasis() {
+    if (view->r != basisView.r || view->theta != basisView.theta || view->phi != basisView.phi) {
+        viewBasisFromPolar(&viewBasis, view);
+        basisView = *view;
+    }
+}
+
+// Sets the directions of the split views, the free view's follow the view
+void updateSplitAxes() {
+    updateViewBasis();
+    Vector x = { 1, 0, 0 }, y = { 0, 1, 0 }, z = { 0, 0, 1 };
+    splitAxes[0][0] = x;
+    splitAxes[0][1] = y;
+    splitAxes[1][0] = viewBasis.w;
+    splitAxes[1][1] = viewBasis.u;
+    splitAxes[2][0] = x;
+    splitAxes[2][1] = z;
+    splitAxes[3][0] = y;
+    splitAxes[3][1] = z;
+}
+
+// Gets the projected x, y screen coordinates of a 3D point along with its
+// depth along the view vector, where greater depths are closer to the viewer
+void projectTo(Tuple3* t, Point* p) {
+    updateViewBasis();
+    viewBasisProject(t, &viewBasis, p);
+}
+
+// Gets the projected x, y screen coordinates of a 3D point
+void coordinatesTo(Tuple2* t, Point* p) {
+    Tuple3 projected;
+    projectTo(&projected, p);
+    t->a = projected.a;
+    t->b = projected.b;
+}
+
+// Moves the drawn items that change with time on to the animation time,
+// returning whether there were any, fields sample into their own data
+// which the worker never reads
+bool animateDrawnItems() {
+    bool animated = false;
+    for (int i = 0; i < drawnCount; i++) {
+        ItemData* data = drawnItems[i].data;
+        if (data == NULL || !data->timed) continue;
+        data->animate(data, animationTime, drawnItems[i].values);
+        animated = true;
+    }
+    return animated;
+}
+
+// Gets the items to draw, copying them again when a new scene has been
+// swapped in, the copies share the scene's data without holding it as
+// the scene holds it for as long as it is drawn
+Item* sceneItems() {
+    if (drawnSwaps != sceneBuilder->swaps) {
+        // Copying up to the old count too empties the items no longer used
+        int count = sceneBuilder->front->count;
+        memcpy(drawnItems, sceneBuilder->front->items, sizeof(Item) * (count > drawnCount ? count : drawnCount));
+        drawnCount = count;
+        drawnSwaps = sceneBuilder->swaps;
+        animateDrawnItems();
+    }
+    return drawnItems;
 }
 
 //
 //      INPUT FUNCTIONS
 //
 
+// Highlights the item on the graph and in the input, showing it in the
+// title of the window, or clears the highlight if it is -1
+void setHovered(int i) {
+    InputWindow_setHighlight(inputWindow, i);
+    if (i == hoveredItem) return;
+    hoveredItem = i;
+    redraw = true;
+    if (i == -1) {
+        SDL_SetWindowTitle(window, TITLE);
+    } else {
+        char title[MAX_EQUATION_LEN + 32];
+        snprintf(title, sizeof(title), "%s - %s", TITLE, InputWindow_getLine(inputWindow, i));
+        SDL_SetWindowTitle(window, title);
+    }
+}
+
 // React to mouse motion
 void mouseMotionEvent(SDL_MouseMotionEvent e) {
     // If the LMB is down
@@ -98,6 +279,11 @@ void mouseMotionEvent(SDL_MouseMotionEvent e) {
         // Update the last examined x, y
         leftMouseDown_x = e.x;
         leftMouseDown_y = e.y;
+    } else {
+        // Find what is under the mouse
+        // What the rasteriser hid behind filled planes can't be picked
+        float* depth = rasterise && !views && rasteriser != NULL ? rasteriser->depth : NULL;
+        setHovered(Picker_pick(picker, e.x, e.y, depth));
     }
 }
 
@@ -121,29 +307,142 @@ void mouseWheelEvent(SDL_MouseWheelEvent e) {
     redraw = true;
 }
 
+// Zooms and sizes the axes so the whole scene fits in the window, the
+// view turns about the origin so it frames the sphere around the origin
+// that holds the scene's bounding sphere, an empty scene gets the axes
+// it started with
+void fitView() {
+    Bounds b;
+    initialiseBounds(&b);
+    Item* items = sceneItems();
+    for (int i = 0; i < drawnCount; i++) {
+        if (items[i].command != NULL) items[i].command->bound(&items[i], &b);
+    }
+    for (int i = 0; stream != NULL && i < stream->count; i++) {
+        Item* item = Stream_get(stream, i);
+        item->command->bound(item, &b);
+    }
+    Point centre;
+    double radius;
+    Bounds_sphere(&b, &centre, &radius);
+    double reach = sqrt(centre.x * centre.x + centre.y * centre.y + centre.z * centre.z) + radius;
+    axisLength = reach > 0 && isfinite(reach) ? reach : AXIS_LENGTH;
+    // The axis labels are the furthest out
+    double pixels = WINDOW_WIDTH_MID < WINDOW_HEIGHT_MID ? WINDOW_WIDTH_MID : WINDOW_HEIGHT_MID;
+    view->r = AXIS_LABEL_SCALE * axisLength / (FIT_MARGIN * pixels);
+    redraw = true;
+}
+
 // React to key presses
 void keyEvent(SDL_KeyboardEvent e) {
+    if (e.type != SDL_KEYDOWN) return;
+    switch (e.keysym.sym) {
+        // Toggle the software rasteriser
+        case SDLK_F2:
+            rasterise = !rasterise;
+            redraw = true;
+        break;
+        // Toggle splitting the graph into views
+        case SDLK_F3:
+            views = !views;
+            redraw = true;
+        break;
+        // Fit the view to the scene
+        case SDLK_F4:
+            fitView();
+        break;
+        // Save the graph as a vector drawing
+        case SDLK_F5:
+            exportWanted = true;
+        break;
+        // Toggle drawing scatters by their density
+        case SDLK_F6:
+            densityMode = !densityMode;
+            redraw = true;
+        break;
+    }
 }
 
 //
 //      DRAWING FUNCTIONS
 //
 
+// Sets the colour graph items are drawn in
+void setDrawColor(SDL_Color c) {
+    drawColor = c;
+    SDL_SetRenderDrawColor(renderer, c.r, c.g, c.b, c.a);
+    if (rasterise && !capturing) Rasteriser_setColor(rasteriser, c);
+}
+
+// Gets the window coordinates of a 3D point and its depth
+void screenCoordinatesTo(Tuple3* t, Point* p) {
+    // The split views each project the point themselves, so it is only
+    // scaled for the zoom level
+    if (capturing) {
+        *t = (Tuple3) { p->x / view->r, p->y / view->r, p->z / view->r };
+        return;
+    }
+    projectTo(t, p);
+    // Scale the point for the zoom level and move it to the window centre
+    t->a = WINDOW_WIDTH_MID + t->a / view->r;
+    t->b = WINDOW_HEIGHT_MID + t->b / view->r;
+}
+
+// Gets how many pixels apart two window coordinates are, while the split
+// views capture it is the most they are apart in any of the views, as
+// the captured points are only scaled and each view projects them
+double screenLength(Tuple3* a, Tuple3* b) {
+    Vector d = { b->a - a->a, b->b - a->b, b->c - a->c };
+    if (!capturing) return sqrt(d.x * d.x + d.y * d.y);
+    double length = 0;
+    for (int k = 0; k < SPLIT_VIEWS; k++) {
+        Vector* right = &splitAxes[k][0];
+        Vector* up = &splitAxes[k][1];
+        double x = d.x * right->x + d.y * right->y + d.z * right->z;
+        double y = d.x * up->x + d.y * up->y + d.z * up->z;
+        length = fmax(length, VIEWS_SCALE * sqrt(x * x + y * y));
+    }
+    return length;
+}
+
+// Draws a line between two window coordinates
+void drawScreenLine(Tuple3* a, Tuple3* b) {
+    if (exporter != NULL) {
+        Exporter_addLine(exporter, a, b, drawColor);
+        return;
+    }
+    if (capturing) {
+        ViewCache_add(viewCache, a, b, NULL, drawingItem, drawColor);
+        return;
+    }
+    if (drawingItem >= 0) Picker_addSegment(picker, a, b, drawingItem);
+    if (rasterise) {
+        Rasteriser_drawLine(rasteriser, a, b);
+    } else {
+        SDL_RenderDrawLine(renderer, a->a, a->b, b->a, b->b);
+    }
+}
+
+// Draws a line between two pixel offsets from a window coordinate
+void drawScreenOffsetLine(Tuple3* t, int x1, int y1, int x2, int y2) {
+    if (capturing) {
+        int offsets[4] = { x1, y1, x2, y2 };
+        ViewCache_add(viewCache, t, t, offsets, drawingItem, drawColor);
+        return;
+    }
+    Tuple3 a = { (int) t->a + x1, (int) t->b + y1, t->c };
+    Tuple3 b = { (int) t->a + x2, (int) t->b + y2, t->c };
+    drawScreenLine(&a, &b);
+}
+
 // Draws a point
 void drawPoint(Point* p) {
     // Get the screen coords of the point
-    Tuple2 coords;
-    coordinatesTo(&coords, p);
-    // Scale the point for the zoom level
-    tuple2Multiply(&coords, 1 / view->r);
-    // Get the points x and y values
-    int c_a = WINDOW_WIDTH_MID + coords.a;
-    int c_b = WINDOW_HEIGHT_MID + coords.b;
+    Tuple3 coords;
+    screenCoordinatesTo(&coords, p);
     // Draw an X centred at the point
-    SDL_RenderDrawLine(renderer, c_a - 5, c_b - 5,
-                                 c_a + 5, c_b + 5);
-    SDL_RenderDrawLine(renderer, c_a + 5, c_b - 5,
-                                 c_a - 5, c_b + 5);
+    drawScreenOffsetLine(&coords, -5, -5, 5, 5);
+    drawScreenOffsetLine(&coords, 5, -5, -5, 5);
 }
 
 // Draws a line
@@ -152,48 +451,76 @@ void drawLine(Line* line) {
     if (line->v->x == 0 && line->v->y == 0 && line->v->z == 0) return;
     Point v;
     Vector stretch;
-    Tuple2 t_p, t_v;
+    Tuple3 t_p, t_v, t_u;
     // Prepare the vector to be stretched
     stretch.x = line->v->x;
     stretch.y = line->v->y;
     stretch.z = line->v->z;
     // Stretch the vector
     reduceToUnit(&stretch);
-    vectorMultiply(&stretch, AXIS_LENGTH << 1);
-    // Get the vector of the line into a point
-    v.x = stretch.x;
-    v.y = stretch.y;
-    v.z = stretch.z;
-    // Gets the screen coordinates of the vector and the point
-    coordinatesTo(&t_p, line->p);
-    coordinatesTo(&t_v, &v);
-    // Scales the points by the zoom level
-    tuple2Multiply(&t_p, 1 / view->r);
-    tuple2Multiply(&t_v, 1 / view->r);
+    vectorMultiply(&stretch, 2 * axisLength);
+    // Gets the screen coordinates of the point and the point +- vector
+    screenCoordinatesTo(&t_p, line->p);
+    v = (Point) { line->p->x + stretch.x, line->p->y + stretch.y, line->p->z + stretch.z };
+    screenCoordinatesTo(&t_v, &v);
+    v = (Point) { line->p->x - stretch.x, line->p->y - stretch.y, line->p->z - stretch.z };
+    screenCoordinatesTo(&t_u, &v);
     // Render the line from the point to the point + vector
-    SDL_RenderDrawLine(renderer, WINDOW_WIDTH_MID + t_p.a, WINDOW_HEIGHT_MID + t_p.b,
-                                 WINDOW_WIDTH_MID + t_p.a + t_v.a, WINDOW_HEIGHT_MID + t_p.b + t_v.b);
-    SDL_RenderDrawLine(renderer, WINDOW_WIDTH_MID + t_p.a, WINDOW_HEIGHT_MID + t_p.b,
-                                 WINDOW_WIDTH_MID + t_p.a - t_v.a, WINDOW_HEIGHT_MID + t_p.b - t_v.b);
+    drawScreenLine(&t_p, &t_v);
+    drawScreenLine(&t_p, &t_u);
 }
 
 // Draws a line
 void drawLineSegment(Line* line) {
     Point v;
-    Tuple2 t_p, t_v;
-    // Get the vector of the line into a point
-    v.x = line->v->x;
-    v.y = line->v->y;
-    v.z = line->v->z; 
-    // Gets the screen coordinates of the vector and the point
-    coordinatesTo(&t_p, line->p);
-    coordinatesTo(&t_v, &v);
-    // Scales the points by the zoom level
-    tuple2Multiply(&t_p, 1 / view->r);
-    tuple2Multiply(&t_v, 1 / view->r);
+    Tuple3 t_p, t_v;
+    // Get the end of the line into a point
+    v.x = line->p->x + line->v->x;
+    v.y = line->p->y + line->v->y;
+    v.z = line->p->z + line->v->z;
+    // Gets the screen coordinates of both ends
+    screenCoordinatesTo(&t_p, line->p);
+    screenCoordinatesTo(&t_v, &v);
     // Render the line from the point to the point + vector
-    SDL_RenderDrawLine(renderer, WINDOW_WIDTH_MID + t_p.a, WINDOW_HEIGHT_MID + t_p.b,
-                                 WINDOW_WIDTH_MID + t_p.a + t_v.a, WINDOW_HEIGHT_MID + t_p.b + t_v.b);
+    drawScreenLine(&t_p, &t_v);
+}
+
+// Draws the outline and grid of a plane from its projected corners,
+// corners[0] to corners[3] going around the plane, with the grid lines
+// a step apart as a fraction of the sides they are spread along, one
+// step along the side 3-0 and the other along the side 3-2
+void drawPlaneGrid(Tuple3 corners[4], double step_30, double step_32) {
+    Tuple3 a, b;
+    // Draw the outline
+    for (int i = 0; i < 4; i++) drawScreenLine(&corners[i], &corners[(i + 1) & 0x3]);
+    // The projection is affine so the grid lines can be interpolated
+    // between the projected corners rather than projected themselves
+    for (int i = 1; step_30 > 0 && i * step_30 < 1; i++) {
+        // Lines running from the side 3-0 to the side 2-1
+        tuple3Lerp(&a, &corners[3], &corners[0], i * step_30);
+        tuple3Lerp(&b, &corners[2], &corners[1], i * step_30);
+        drawScreenLine(&a, &b);
+    }
+    for (int i = 1; step_32 > 0 && i * step_32 < 1; i++) {
+        // Lines running from the side 3-2 to the side 0-1
+        tuple3Lerp(&a, &corners[3], &corners[2], i * step_32);
+        tuple3Lerp(&b, &corners[0], &corners[1], i * step_32);
+        drawScreenLine(&a, &b);
+    }
+}
+
+// Gets the grid step along one side of a plane, as a fraction of the
+// side, from how long the side is projected on the screen, each side
+// gets its own step so a plane seen edge on doesn't crowd its short side
+double planeGridStep(Tuple3* from, Tuple3* to) {
+    double side = 2 * PLANE_SCALE * axisLength;
+    double pixels = screenLength(from, to);
+    if (pixels == 0) return 0;
+    // Choose the world spacing so the lines are far enough apart on
+    // screen, and so there are never too many of them
+    double spacing = niceStep(side * PLANE_GRID_PIXELS / pixels);
+    while (side / spacing > PLANE_GRID_MAX_LINES) spacing = niceStep(spacing * 1.5);
+    return spacing / side;
 }
 
 // Draws a plane
@@ -207,16 +534,15 @@ void drawPlane(Plane* p) {
     reduceToUnit(&norm);
     vectorMultiply(&norm, p->constant);
 
-    Line l;
-    Vector vector;
     Point point;
     Vector e[4];
     Vector v1, v2;
+    Tuple3 corners[4];
     // Get the orthonormals to the plane
     getOrthonormals(p, &v1, &v2);
     // Multiply them so they are as large as we want the plane
-    vectorMultiply(&v1, PLANE_SCALE * AXIS_LENGTH);
-    vectorMultiply(&v2, PLANE_SCALE * AXIS_LENGTH);
+    vectorMultiply(&v1, PLANE_SCALE * axisLength);
+    vectorMultiply(&v2, PLANE_SCALE * axisLength);
     // Get the four corners of the plane as points
     vectorSum(&e[0], &v1, &v2);
     vectorMultiply(&v2, -1);
@@ -225,161 +551,529 @@ void drawPlane(Plane* p) {
     vectorSum(&e[2], &v1, &v2);
     vectorMultiply(&v2, -1);
     vectorSum(&e[3], &v1, &v2);
-    // Draw the line between the points
-    for (int i = 1; i < 4; i++) {
-        point = (Point) { e[i - 1].x + norm.x, e[i - 1].y + norm.y, e[i - 1].z + norm.z };
-        vector = (Vector) { e[i].x - e[i - 1].x, e[i].y - e[i - 1].y, e[i].z - e[i - 1].z };
-        l.p = &point;
-        l.v = &vector;
-        drawLineSegment(&l);
-    }
-    point = (Point) { e[3].x + norm.x, e[3].y + norm.y, e[3].z + norm.z };
-    vector = (Vector) { e[0].x - e[3].x, e[0].y - e[3].y, e[0].z - e[3].z };
-    l.p = &point;
-    l.v = &vector;
-    drawLineSegment(&l);
-    // Get the orthonormals again and resize appropriately
-    getOrthonormals(p, &v1, &v2);
-    vectorMultiply(&v1, PLANE_LINES_SCALE);
-    vectorMultiply(&v2, PLANE_LINES_SCALE);
-    // Get the points we want to draw between
-    Point p1 = (Point) { e[3].x + norm.x, e[3].y + norm.y, e[3].z + norm.z };
-    Point p2 = (Point) { e[3].x + norm.x, e[3].y + norm.y, e[3].z + norm.z };
-    // Get the vectors of the lines we want to draw
-    Vector u1 = (Vector) { e[0].x - e[3].x, e[0].y - e[3].y, e[0].z - e[3].z };
-    Vector u2 = (Vector) { e[2].x - e[3].x, e[2].y - e[3].y, e[2].z - e[3].z };
-    for (int i = 1; i < 2 * (PLANE_SCALE * AXIS_LENGTH) / PLANE_LINES_SCALE; i++) {
-        // Move the points along
-        p1.x += v1.x;
-        p1.y += v1.y;
-        p1.z += v1.z;
-        p2.x -= v2.x;
-        p2.y -= v2.y;
-        p2.z -= v2.z;
-        // Draw both lines
-        l.p = &p1;
-        l.v = &u2;
-        drawLineSegment(&l);
-        l.p = &p2;
-        l.v = &u1;
-        drawLineSegment(&l);
+    // Project the corners, these are the only points of the plane that
+    // need to go through the projection
+    for (int i = 0; i < 4; i++) {
+        point = (Point) { e[i].x + norm.x, e[i].y + norm.y, e[i].z + norm.z };
+        screenCoordinatesTo(&corners[i], &point);
+    }
+    // Fill the plane in so it hides what is behind it
+    if (rasterise && !capturing) {
+        Rasteriser_fillTriangle(rasteriser, &corners[0], &corners[1], &corners[2]);
+        Rasteriser_fillTriangle(rasteriser, &corners[2], &corners[3], &corners[0]);
+    }
+    drawPlaneGrid(corners, planeGridStep(&corners[3], &corners[0]), planeGridStep(&corners[3], &corners[2]));
+}
+
+// Draws a unit mesh moved to the origin and stretched along the axes,
+// only the origin and the ends of the axes go through the projection and
+// the vertices are placed from them, as the projection is affine
+void drawMesh(MeshShape shape, Point* origin, Vector axes[3]) {
+    if (meshes == NULL) meshes = initialiseMeshSet();
+    Tuple3 o, ends[3];
+    screenCoordinatesTo(&o, origin);
+    // The detail comes from how big the round axes are on screen
+    double pixels = 0;
+    for (int k = 0; k < 3; k++) {
+        Point end = { origin->x + axes[k].x, origin->y + axes[k].y, origin->z + axes[k].z };
+        screenCoordinatesTo(&ends[k], &end);
+        if (!(shape == MESH_CYLINDER && k == 2)) pixels = fmax(pixels, screenLength(&o, &ends[k]));
+        ends[k] = (Tuple3) { ends[k].a - o.a, ends[k].b - o.b, ends[k].c - o.c };
+    }
+    Mesh* m = &meshes->meshes[shape][meshLevel(pixels)];
+    Tuple3* projected = meshes->projected;
+    for (int i = 0; i < m->vertex_count; i++) {
+        Point* v = &m->vertices[i];
+        projected[i].a = o.a + v->x * ends[0].a + v->y * ends[1].a + v->z * ends[2].a;
+        projected[i].b = o.b + v->x * ends[0].b + v->y * ends[1].b + v->z * ends[2].b;
+        projected[i].c = o.c + v->x * ends[0].c + v->y * ends[1].c + v->z * ends[2].c;
+    }
+    for (int i = 0; i < m->edge_count; i++) {
+        drawScreenLine(&projected[m->edges[2 * i]], &projected[m->edges[2 * i + 1]]);
+    }
+}
+
+// Draws the ellipsoid with the radii along each axis
+void drawEllipsoid(Point* centre, double rx, double ry, double rz) {
+    Vector axes[3] = { { rx, 0, 0 }, { 0, ry, 0 }, { 0, 0, rz } };
+    drawMesh(MESH_SPHERE, centre, axes);
+}
+
+// Draws the cylinder from the base along the axis with the radius
+void drawCylinder(Point* base, Vector* axis, double r) {
+    // If the axis is zero, return
+    if (axis->x == 0 && axis->y == 0 && axis->z == 0) return;
+    // The circles are in the plane normal to the axis
+    Plane p = { axis->x, axis->y, axis->z, 0 };
+    Vector axes[3];
+    getOrthonormals(&p, &axes[0], &axes[1]);
+    vectorMultiply(&axes[0], r);
+    vectorMultiply(&axes[1], r);
+    axes[2] = *axis;
+    drawMesh(MESH_CYLINDER, base, axes);
+}
+
+// Gets the window coordinates of many points at once into the batch
+Tuple3* projectBatch(Point* points, int count) {
+    if (count > batchCapacity) {
+        batchCapacity = count;
+        batch = realloc(batch, sizeof(Tuple3) * batchCapacity);
+    }
+    for (int i = 0; i < count; i++) screenCoordinatesTo(&batch[i], &points[i]);
+    return batch;
+}
+
+// Draws the field's arrows from their vertices projected as one batch,
+// each as its shaft and the two lines of its head
+void drawField(Field* f) {
+    Tuple3* t = projectBatch(f->vertices, 4 * f->arrow_count);
+    for (int i = 0; i < f->arrow_count; i++, t += 4) {
+        drawScreenLine(&t[0], &t[1]);
+        drawScreenLine(&t[1], &t[2]);
+        drawScreenLine(&t[1], &t[3]);
+    }
+}
+
+// Draws the cloud's points like drawPoint, or a line through them in
+// order if it is a path, projecting PROJECT_BATCH points at a time
+void drawCloud(Cloud* c, bool path) {
+    // Part of a progressive frame projects each point or segment it draws
+    // on its own as they aren't next to each other
+    if (strata > 1) {
+        for (int i = stratum; i < c->count; i += strata) {
+            Tuple3 a, b;
+            screenCoordinatesTo(&a, &c->points[i]);
+            if (!path) {
+                drawScreenOffsetLine(&a, -5, -5, 5, 5);
+                drawScreenOffsetLine(&a, 5, -5, -5, 5);
+                continue;
+            }
+            if (i + 1 == c->count) break;
+            screenCoordinatesTo(&b, &c->points[i + 1]);
+            drawScreenLine(&a, &b);
+        }
+        return;
+    }
+    Tuple3 last;
+    for (int start = 0; start < c->count; start += PROJECT_BATCH) {
+        int count = c->count - start < PROJECT_BATCH ? c->count - start : PROJECT_BATCH;
+        Tuple3* t = projectBatch(c->points + start, count);
+        for (int i = 0; i < count; i++) {
+            if (!path) {
+                drawScreenOffsetLine(&t[i], -5, -5, 5, 5);
+                drawScreenOffsetLine(&t[i], 5, -5, -5, 5);
+            } else if (start + i > 0) {
+                drawScreenLine(i == 0 ? &last : &t[i - 1], &t[i]);
+            }
+        }
+        last = t[count - 1];
+    }
+}
+
+// Draws a plane item
+void drawPlaneItem(Item* item) {
+    double* v = item->values;
+    Plane p = { v[0], v[1], v[2], v[3] };
+    drawPlane(&p);
+}
+
+// Draws a point item
+void drawPointItem(Item* item) {
+    double* v = item->values;
+    Point p = { v[0], v[1], v[2] };
+    drawPoint(&p);
+}
+
+// Draws a line item
+void drawLineItem(Item* item) {
+    double* v = item->values;
+    Line l;
+    Point p = { v[0], v[1], v[2] };
+    Vector u = { v[3], v[4], v[5] };
+    l.p = &p;
+    l.v = &u;
+    drawLine(&l);
+}
+
+// Draws a sphere item
+void drawSphereItem(Item* item) {
+    double* v = item->values;
+    Point c = { v[0], v[1], v[2] };
+    drawEllipsoid(&c, v[3], v[3], v[3]);
+}
+
+// Draws an ellipsoid item
+void drawEllipsoidItem(Item* item) {
+    double* v = item->values;
+    Point c = { v[0], v[1], v[2] };
+    drawEllipsoid(&c, v[3], v[4], v[5]);
+}
+
+// Draws a cylinder item
+void drawCylinderItem(Item* item) {
+    double* v = item->values;
+    Point b = { v[0], v[1], v[2] };
+    Vector axis = { v[3], v[4], v[5] };
+    drawCylinder(&b, &axis, v[6]);
+}
+
+// Draws a field item
+void drawFieldItem(Item* item) {
+    drawField((Field*) item->data);
+}
+
+// Draws a scatter item
+void drawScatterItem(Item* item) {
+    Cloud* c = (Cloud*) item->data;
+    if (splatting) {
+        updateViewBasis();
+        DensityMap_addPoints(density, c->points, c->count, &viewBasis, view->r);
+        return;
     }
+    drawCloud(c, false);
+}
+
+// Draws a path item
+void drawPathItem(Item* item) {
+    drawCloud((Cloud*) item->data, true);
+}
+
+// Draws where the scene's lines and planes meet
+void drawIntersectItem(Item* item) {
+    Intersections* in = &sceneBuilder->front->intersections;
+    for (int j = 0; j < in->point_count; j++) drawPoint(&in->points[j]);
+    for (int j = 0; j < in->line_count; j++) {
+        Line l = { &in->line_vectors[j], &in->line_points[j] };
+        drawLine(&l);
+    }
+}
+
+// Bounds a plane item by the point on it its drawing is centred on
+void boundPlaneItem(Item* item, Bounds* b) {
+    double* v = item->values;
+    double length = sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    if (length == 0) return;
+    Point p = { v[0] * v[3] / length, v[1] * v[3] / length, v[2] * v[3] / length };
+    Bounds_addPoint(b, &p);
+}
+
+// Bounds a point item, or a line item by the point it goes through
+void boundPointItem(Item* item, Bounds* b) {
+    double* v = item->values;
+    Point p = { v[0], v[1], v[2] };
+    Bounds_addPoint(b, &p);
+}
+
+void boundSphereItem(Item* item, Bounds* b) {
+    double* v = item->values;
+    Point c = { v[0], v[1], v[2] };
+    Bounds_addBox(b, &c, v[3], v[3], v[3]);
+}
+
+void boundEllipsoidItem(Item* item, Bounds* b) {
+    double* v = item->values;
+    Point c = { v[0], v[1], v[2] };
+    Bounds_addBox(b, &c, v[3], v[4], v[5]);
+}
+
+// Bounds a cylinder item by boxes around the centres of its ends
+void boundCylinderItem(Item* item, Bounds* b) {
+    double* v = item->values;
+    Point base = { v[0], v[1], v[2] };
+    Point end = { v[0] + v[3], v[1] + v[4], v[2] + v[5] };
+    Bounds_addBox(b, &base, v[6], v[6], v[6]);
+    Bounds_addBox(b, &end, v[6], v[6], v[6]);
+}
+
+// Bounds a field item by the lattice it is sampled on
+void boundFieldItem(Item* item, Bounds* b) {
+    Point origin = { 0, 0, 0 };
+    Bounds_addBox(b, &origin, AXIS_LENGTH, AXIS_LENGTH, AXIS_LENGTH);
+}
+
+// Bounds a scatter or path item, splitting its points across threads
+void boundCloudItem(Item* item, Bounds* b) {
+    Cloud* c = (Cloud*) item->data;
+    Bounds_addPoints(b, c->points, c->count, threadPool);
+}
+
+// Bounds where the scene's lines and planes meet
+void boundIntersectItem(Item* item, Bounds* b) {
+    Intersections* in = &sceneBuilder->front->intersections;
+    for (int j = 0; j < in->point_count; j++) Bounds_addPoint(b, &in->points[j]);
+    for (int j = 0; j < in->line_count; j++) Bounds_addPoint(b, &in->line_points[j]);
 }
 
 // Draws an axis
 void drawAxis(int x, int y, int z) {
     Line l;
     // Gets the vector to the end of the axis
-    Vector l_v = { AXIS_LENGTH * x, AXIS_LENGTH * y, AXIS_LENGTH * z };
+    Vector l_v = { axisLength * x, axisLength * y, axisLength * z };
     Point l_p = { 0, 0, 0 };
     l.v = &l_v;
     l.p = &l_p;
     // Draw the main axis line
     drawLineSegment(&l);
-    // Sets up variables for future calculation
-    int mod_x = 0, mod_y = 0, mod_z = 0;
-    if (x == 0) {
-        mod_x = 1;
-    } else if (y == 0) {
-        mod_y = 1;
-    } else {
-        mod_z = 1;
-    }
     // Draw the axis arrows
-    l_p.x = l_v.x;
-    l_p.y = l_v.y;
-    l_p.z = l_v.z;
-    l_v.x = AXIS_ARROW_SIZE * (mod_x - x);
-    l_v.y = AXIS_ARROW_SIZE * (mod_y - y);
-    l_v.z = AXIS_ARROW_SIZE * (mod_z - z);
-    drawLineSegment(&l);
-    l_v.x = AXIS_ARROW_SIZE * (-mod_x - x);
-    l_v.y = AXIS_ARROW_SIZE * (-mod_y - y);
-    l_v.z = AXIS_ARROW_SIZE * (-mod_z - z);
-    drawLineSegment(&l);
+    Point tip = { l_v.x, l_v.y, l_v.z }, head[2];
+    arrowHead(head, &tip, &l_v, AXIS_ARROW_SCALE);
+    Tuple3 t_tip, t_head;
+    screenCoordinatesTo(&t_tip, &tip);
+    for (int k = 0; k < 2; k++) {
+        screenCoordinatesTo(&t_head, &head[k]);
+        drawScreenLine(&t_tip, &t_head);
+    }
 
-    Tuple2 coords;
-    Point p = { (AXIS_LENGTH + 20) * x, (AXIS_LENGTH + 20) * y, (AXIS_LENGTH + 20) * z };
-    coordinatesTo(&coords, &p);
-    tuple2Multiply(&coords, 1 / view->r);
+    Tuple3 coords;
+    double label = AXIS_LABEL_SCALE * axisLength;
+    Point p = { label * x, label * y, label * z };
+    screenCoordinatesTo(&coords, &p);
 
-    int c_a = WINDOW_WIDTH_MID + coords.a;
-    int c_b = WINDOW_HEIGHT_MID + coords.b;
     if (x > 0 && y == 0 && z == 0) {
-        SDL_RenderDrawLine(renderer, c_a - 5, c_b - 5,
-                                     c_a + 5, c_b + 5);
-        SDL_RenderDrawLine(renderer, c_a + 5, c_b - 5,
-                                     c_a - 5, c_b + 5);
+        drawScreenOffsetLine(&coords, -5, -5, 5, 5);
+        drawScreenOffsetLine(&coords, 5, -5, -5, 5);
     }
     if (x == 0 && y > 0 && z == 0) {
-        SDL_RenderDrawLine(renderer, c_a - 5, c_b - 5,
-                                     c_a, c_b);
-        SDL_RenderDrawLine(renderer, c_a + 5, c_b - 5,
-                                     c_a - 5, c_b + 5);
+        drawScreenOffsetLine(&coords, -5, -5, 0, 0);
+        drawScreenOffsetLine(&coords, 5, -5, -5, 5);
     }
     if (x == 0 && y == 0 && z > 0) {
-        SDL_RenderDrawLine(renderer, c_a - 5, c_b - 5,
-                                     c_a + 5, c_b - 5);
-        SDL_RenderDrawLine(renderer, c_a + 5, c_b - 5,
-                                     c_a - 5, c_b + 5);
-        SDL_RenderDrawLine(renderer, c_a - 5, c_b + 5,
-                                     c_a + 5, c_b + 5);    
+        drawScreenOffsetLine(&coords, -5, -5, 5, -5);
+        drawScreenOffsetLine(&coords, 5, -5, -5, 5);
+        drawScreenOffsetLine(&coords, -5, 5, 5, 5);
     }
 }
 
-// Draws to the window
-void draw() {
-    // Attempt to draw the input window (it handles its own redraws)
-    drawInputWindow(inputWindow);
-    // Check if we can draw
-    if (!redraw) return;
-    redraw = false;
-    // Clear the renderer
-    SDL_RenderClear(renderer);
-    // Draws the background
-    SDL_SetRenderDrawColor(renderer, BG_R, BG_G, BG_B, 255);
-    SDL_RenderFillRect(renderer, NULL);
-    
-    // Start drawing the graph
+// Draws an item in its colour, or the hover colour if it is under the mouse
+void drawItem(Item* items, int i) {
+    drawingItem = i;
+    if (i == hoveredItem) {
+        setDrawColor((SDL_Color) { HOVER_R, HOVER_G, HOVER_B, 255 });
+    } else {
+        setDrawColor(colors[i]);
+    }
+    items[i].command->draw(&items[i]);
+    drawingItem = -1;
+}
+
+// Draws the axes and every item
+void drawScene() {
+    drawingItem = -1;
     // Draw the axes
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    setDrawColor((SDL_Color) { 255, 255, 255, 255 });
     drawAxis(1, 0, 0);
     drawAxis(0, 1, 0);
     drawAxis(0, 0, 1);
-    SDL_SetRenderDrawColor(renderer, 120, 120, 120, 255);
+    setDrawColor((SDL_Color) { 120, 120, 120, 255 });
     drawAxis(-1, 0, 0);
     drawAxis(0, -1, 0);
     drawAxis(0, 0, -1);
-    // Sift through the input for anything worthwhile
-    char s[MAX_EQUATION_LEN];
-    float a, b, c, d, e, f;
-    a = b = c = d = e = f = 0;
-    for (int i = 0; i < MAX_ITEMS; i++) {
-        if (strncmp(inputWindow->input[i], "", 1) == 0) continue;
-        sscanf(inputWindow->input[i], "%s %f %f %f %f %f %f", s, &a, &b, &c, &d, &e, &f);
-        SDL_SetRenderDrawColor(renderer, colors[i].r, colors[i].g, colors[i].b, colors[i].a);
-        if (strncmp("plane", s, 5) == 0) {
-            Plane p = { a, b, c, d };
-            drawPlane(&p);
-            a = b = c = d = e = f = 0;
+    // Draw the items parsed from the input
+    Item* items = sceneItems();
+    for (int i = 0; i < drawnCount; i++) {
+        if (items[i].type != ITEM_NONE) drawItem(items, i);
+    }
+    // Draw the streamed records, oldest first so the newest are on top
+    if (stream == NULL) return;
+    setDrawColor((SDL_Color) { STREAM_R, STREAM_G, STREAM_B, 255 });
+    for (int i = 0; i < stream->count; i++) {
+        Item* item = Stream_get(stream, i);
+        item->command->draw(item);
+    }
+}
+
+void drawGraph() {
+    Picker_clear(picker);
+    drawScene();
+    // Sort what was drawn so the mouse can find it
+    Picker_build(picker);
+}
+
+// Draws the cached segments through one of the split views, in the
+// rectangle with the directions in the graph that go right and up in it
+void drawView(SDL_Rect* rect, Vector* right, Vector* up) {
+    SDL_RenderSetClipRect(renderer, rect);
+    double mid_x = rect->x + rect->w / 2.0, mid_y = rect->y + rect->h / 2.0;
+    double min_x = rect->x, max_x = rect->x + rect->w;
+    double min_y = rect->y, max_y = rect->y + rect->h;
+    SDL_Color color = { 0, 0, 0, 0 };
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    for (int i = 0; i < viewCache->count; i++) {
+        CachedSegment* s = &viewCache->segments[i];
+        Tuple3 a = {
+            mid_x + VIEWS_SCALE * (s->a.x * right->x + s->a.y * right->y + s->a.z * right->z) + s->offsets[0],
+            mid_y - VIEWS_SCALE * (s->a.x * up->x + s->a.y * up->y + s->a.z * up->z) + s->offsets[1], 0 };
+        Tuple3 b = {
+            mid_x + VIEWS_SCALE * (s->b.x * right->x + s->b.y * right->y + s->b.z * right->z) + s->offsets[2],
+            mid_y - VIEWS_SCALE * (s->b.x * up->x + s->b.y * up->y + s->b.z * up->z) + s->offsets[3], 0 };
+        // Skip segments wholly to one side of the view
+        if ((a.a < min_x && b.a < min_x) || (a.a > max_x && b.a > max_x)) continue;
+        if ((a.b < min_y && b.b < min_y) || (a.b > max_y && b.b > max_y)) continue;
+        if (s->color.r != color.r || s->color.g != color.g || s->color.b != color.b || s->color.a != color.a) {
+            color = s->color;
+            SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
         }
-        if (strncmp("point", s, 5) == 0) {
-            Point p = { a, b, c };
-            drawPoint(&p);
-            a = b = c = d = e = f = 0;
+        SDL_RenderDrawLine(renderer, a.a, a.b, b.a, b.b);
+        if (s->item >= 0) Picker_addSegment(picker, &a, &b, s->item);
+    }
+    SDL_RenderSetClipRect(renderer, NULL);
+}
+
+// Draws the graph once into the cache, then through the top, front and
+// side views laid out as an engineering drawing and the free view in
+// the corner left over
+void drawViews() {
+    if (viewCache == NULL) viewCache = initialiseViewCache();
+    ViewCache_clear(viewCache);
+    Picker_clear(picker);
+    // The views' directions are needed to size what is captured
+    updateSplitAxes();
+    capturing = true;
+    drawScene();
+    capturing = false;
+    SDL_Rect topView = { 0, 0, WINDOW_WIDTH_MID, WINDOW_HEIGHT_MID };
+    SDL_Rect freeView = { WINDOW_WIDTH_MID, 0, WINDOW_WIDTH_MID, WINDOW_HEIGHT_MID };
+    SDL_Rect frontView = { 0, WINDOW_HEIGHT_MID, WINDOW_WIDTH_MID, WINDOW_HEIGHT_MID };
+    SDL_Rect sideView = { WINDOW_WIDTH_MID, WINDOW_HEIGHT_MID, WINDOW_WIDTH_MID, WINDOW_HEIGHT_MID };
+    drawView(&topView, &splitAxes[0][0], &splitAxes[0][1]);
+    drawView(&freeView, &splitAxes[1][0], &splitAxes[1][1]);
+    drawView(&frontView, &splitAxes[2][0], &splitAxes[2][1]);
+    drawView(&sideView, &splitAxes[3][0], &splitAxes[3][1]);
+    // Draw the lines between the views
+    SDL_SetRenderDrawColor(renderer, 120, 120, 120, 255);
+    SDL_RenderDrawLine(renderer, WINDOW_WIDTH_MID, 0, WINDOW_WIDTH_MID, WINDOW_HEIGHT);
+    SDL_RenderDrawLine(renderer, 0, WINDOW_HEIGHT_MID, WINDOW_WIDTH, WINDOW_HEIGHT_MID);
+    Picker_build(picker);
+}
+
+// Gets which stratum is drawn kth, the bits of k reversed, so each part
+// drawn lands between the ones drawn before
+int stratumOrder(int k) {
+    int order = 0;
+    for (int bit = 1, reversed = PROGRESSIVE_STRATA >> 1; bit < PROGRESSIVE_STRATA; bit <<= 1, reversed >>= 1) {
+        if (k & bit) order |= reversed;
+    }
+    return order;
+}
+
+// Draws more strata of the big items on top of the frame until the time
+// since start is up, or all of them if the frame can't be kept for later
+void refineGraph(Uint64 start) {
+    Uint64 budget = PROGRESSIVE_BUDGET * SDL_GetPerformanceFrequency() / 1000;
+    bool first = drawnStrata == 1;
+    strata = PROGRESSIVE_STRATA;
+    while (drawnStrata < PROGRESSIVE_STRATA
+            && (graphTexture == NULL || SDL_GetPerformanceCounter() - start < budget)) {
+        stratum = stratumOrder(drawnStrata++);
+        Item* items = sceneItems();
+        for (int i = 0; i < drawnCount; i++) {
+            // Splatted scatters were drawn whole with the first stratum
+            if ((items[i].type == ITEM_SCATTER && !densityMode) || items[i].type == ITEM_PATH) drawItem(items, i);
         }
-        if (strncmp("line", s, 4) == 0) {
-            Line l;
-            Point p = { a, b, c };
-            Vector v = { d, e, f };
-            l.p = &p;
-            l.v = &v;
-            drawLine(&l);            
+        // Rasterising what was drawn counts against the time too
+        if (rasterise) Rasteriser_flush(rasteriser);
+    }
+    stratum = 0;
+    strata = 1;
+    refining = drawnStrata < PROGRESSIVE_STRATA;
+    // Sort what was drawn so the mouse can find it, in between the mouse
+    // finds what the first frame drew
+    if (first || !refining) Picker_build(picker);
+    if (rasterise) drawRasteriser(rasteriser, renderer);
+    // The density goes on top, again whenever the rasteriser covers it
+    if (density != NULL && density->count > 0 && (first || rasterise)) drawDensityMap(density, renderer);
+}
+
+// Draws the graph to the renderer, or its target texture
+void renderGraph() {
+    // Clear the renderer
+    SDL_RenderClear(renderer);
+    // Draws the background
+    SDL_SetRenderDrawColor(renderer, BG_R, BG_G, BG_B, 255);
+    SDL_RenderFillRect(renderer, NULL);
+    refining = false;
+    // The split views only draw lines
+    if (views) {
+        drawViews();
+        return;
+    }
+    if (rasterise) {
+        if (rasteriser == NULL) {
+            rasteriser = initialiseRasteriser(renderer, WINDOW_WIDTH, WINDOW_HEIGHT, 1, threadPool);
         }
+        Rasteriser_clear(rasteriser, (SDL_Color) { BG_R, BG_G, BG_B, 255 });
     }
 
-    // ----------------
+    if (densityMode && density == NULL) density = initialiseDensityMap(renderer, WINDOW_WIDTH, WINDOW_HEIGHT, threadPool);
+    if (density != NULL) DensityMap_clear(density);
+
+    // The first stratum of the big items is drawn with everything else,
+    // and every point of the scatters splatted if they are by density
+    Uint64 start = SDL_GetPerformanceCounter();
+    Picker_clear(picker);
+    strata = PROGRESSIVE_STRATA;
+    stratum = stratumOrder(0);
+    splatting = densityMode;
+    drawScene();
+    splatting = false;
+    drawnStrata = 1;
+    refineGraph(start);
+}
 
+// Draws the free view of the graph as an SVG file, streaming each segment
+// to it as it is projected, the planes aren't filled in as the
+// rasteriser would
+bool exportToFile(const char* file) {
+    exporter = initialiseExporter(file, WINDOW_WIDTH, WINDOW_HEIGHT, (SDL_Color) { BG_R, BG_G, BG_B, 255 });
+    if (exporter == NULL) return false;
+    bool raster = rasterise;
+    rasterise = false;
+    drawScene();
+    rasterise = raster;
+    bool saved = Exporter_finish(exporter);
+    freeExporter(exporter);
+    exporter = NULL;
+    return saved;
+}
+
+// Draws whatever has changed
+void draw() {
+    if (exportWanted) {
+        exportWanted = false;
+        if (exportToFile(EXPORT_FILE)) {
+            printf("Exported the graph to %s\n", EXPORT_FILE);
+        } else {
+            printf("Could not export to %s\n", EXPORT_FILE);
+        }
+    }
+    // The input window has its own renderer
+    if (!single && inputWindow->redraw) drawInputWindow(inputWindow);
+    // The graph is drawn into its texture, so a frame left unfinished can
+    // be carried on with in the next
+    bool drawing = redraw || refining;
+    if (!drawing && !(single && inputWindow->redraw)) return;
+    if (drawing) {
+        SDL_SetRenderTarget(renderer, graphTexture);
+        if (redraw) {
+            redraw = false;
+            renderGraph();
+        } else {
+            refineGraph(SDL_GetPerformanceCounter());
+        }
+        SDL_SetRenderTarget(renderer, NULL);
+    }
+    if (!single) {
+        if (graphTexture != NULL) SDL_RenderCopy(renderer, graphTexture, NULL, NULL);
+        SDL_RenderPresent(renderer);
+        return;
+    }
+    // Both go out in one present, the graph is copied back from its
+    // texture when only the panel has changed
+    SDL_SetRenderDrawColor(renderer, BG_R, BG_G, BG_B, 255);
+    SDL_RenderClear(renderer);
+    SDL_Rect graph = { INPUTWIN_WIDTH, 0, WINDOW_WIDTH, WINDOW_HEIGHT };
+    SDL_RenderCopy(renderer, graphTexture, NULL, &graph);
+    drawInputWindow(inputWindow);
     SDL_RenderPresent(renderer);
 }
 
@@ -387,10 +1081,39 @@ void draw() {
 //      MAIN FUNCTIONS
 //
 
+// Hands the edited lines of input to the scene builder and swaps in any
+// scene it has finished, the builder only makes a new scene if an item's
+// geometry has actually changed (the colours come from the line so stay
+// the same)
+void updateItems() {
+    if (InputWindow_dropRedraw(inputWindow)) {
+        for (int i = 0; i < MAX_ITEMS; i++) {
+            if (!InputWindow_dropChanged(inputWindow, i)) continue;
+            SceneBuilder_setLine(sceneBuilder, i, InputWindow_getLine(inputWindow, i));
+        }
+        SceneBuilder_submit(sceneBuilder);
+    }
+    // Replays have to draw the same frames every time
+    if (recorder != NULL && recorder->replaying) {
+        if (SceneBuilder_wait(sceneBuilder)) redraw = true;
+    } else {
+        if (SceneBuilder_swap(sceneBuilder)) redraw = true;
+    }
+}
+
+// Moves the items that change with time on to the next update
+void animateItems() {
+    animationTime += UPDATE_DELTA_TIME / 1000.0;
+    sceneItems();
+    if (animateDrawnItems()) redraw = true;
+}
+
 // Updates components
 void update() {
     updateInputWindow(inputWindow);
-    redraw |= InputWindow_dropRedraw(inputWindow);
+    updateItems();
+    animateItems();
+    if (stream != NULL && Stream_update(stream) > 0) redraw = true;
 
     while (view->phi > 2 * PI) {
         view->phi -= 2 * PI;
@@ -407,8 +1130,103 @@ void windowEvent(SDL_Event* e) {
             e->type = SDL_QUIT;
             SDL_PushEvent(e);
         break;
+        case SDL_WINDOWEVENT_EXPOSED:
+            if (e->window.windowID == SDL_GetWindowID(window)) {
+                redraw = true;
+            } else {
+                inputWindow->redraw = true;
+            }
+        break;
         case SDL_WINDOWEVENT_LEAVE:
             if (e->window.windowID == SDL_GetWindowID(window)) leftMouseDown = false;
+            setHovered(-1);
+        break;
+    }
+}
+
+// Gets the ID of the input window, or 0 if it is a panel in the graph's
+int inputWindowID() {
+    return inputWindow->window == NULL ? 0 : SDL_GetWindowID(inputWindow->window);
+}
+
+// Gets which windows have focus for an event, as the recorder stores it,
+// in single window mode mouse events over the graph are moved into its
+// coordinates
+int currentFocus(SDL_Event* e) {
+    int focus = 0;
+    if (!single) {
+        if (isKeyFocused(window)) focus |= RECORDER_GRAPH_KEYS;
+        if (isKeyFocused(inputWindow->window)) focus |= RECORDER_INPUT_KEYS;
+        if (isMouseFocused(window)) focus |= RECORDER_GRAPH_MOUSE;
+        if (isMouseFocused(inputWindow->window)) focus |= RECORDER_INPUT_MOUSE;
+        return focus;
+    }
+    if (isKeyFocused(window)) focus |= RECORDER_GRAPH_KEYS | RECORDER_INPUT_KEYS;
+    if (!isMouseFocused(window)) return focus;
+    int x;
+    if (e->type == SDL_MOUSEMOTION) {
+        x = e->motion.x;
+    } else if (e->type == SDL_MOUSEBUTTONDOWN || e->type == SDL_MOUSEBUTTONUP) {
+        x = e->button.x;
+    } else {
+        SDL_GetMouseState(&x, NULL);
+    }
+    // Drags that start on the graph stay with it
+    if (!leftMouseDown && x < INPUTWIN_WIDTH) return focus | RECORDER_INPUT_MOUSE;
+    if (e->type == SDL_MOUSEMOTION) e->motion.x -= INPUTWIN_WIDTH;
+    if (e->type == SDL_MOUSEBUTTONDOWN || e->type == SDL_MOUSEBUTTONUP) {
+        e->button.x -= INPUTWIN_WIDTH;
+    }
+    return focus | RECORDER_GRAPH_MOUSE;
+}
+
+// Sends an event to the windows that had focus when it happened
+void handleEvent(SDL_Event* e, int focus) {
+    switch(e->type) {
+        // Quitting the game (on exit, ALT+F4, etc.)
+        case SDL_QUIT:
+            running = false;
+        break;
+        // When a key is pressed or released
+        case SDL_KEYUP:
+        case SDL_KEYDOWN:
+            if (focus & RECORDER_GRAPH_KEYS) keyEvent(e->key);
+            if (focus & RECORDER_INPUT_KEYS) {
+                InputWindow_keyEvent(inputWindow, e->key);
+            }
+        break;
+        // When text is typed
+        case SDL_TEXTINPUT:
+            if (focus & RECORDER_INPUT_KEYS) {
+                InputWindow_textEvent(inputWindow, e->text);
+            }
+        break;
+        // When mouse motion occurs
+        case SDL_MOUSEMOTION:
+            if (focus & RECORDER_GRAPH_MOUSE) mouseMotionEvent(e->motion);
+            if (focus & RECORDER_INPUT_MOUSE) {
+                InputWindow_mouseMotionEvent(inputWindow, e->motion);
+                setHovered(inputWindow->highlight);
+            }
+        break;
+        // When the mouse buttons are pressed
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEBUTTONDOWN:
+            if (focus & RECORDER_GRAPH_MOUSE) mouseButtonEvent(e->button);
+            if (focus & RECORDER_INPUT_MOUSE) {
+                InputWindow_mouseButtonEvent(inputWindow, e->button);
+            }
+        break;
+        // When the mouse wheel is moved
+        case SDL_MOUSEWHEEL:
+            if (focus & RECORDER_GRAPH_MOUSE) mouseWheelEvent(e->wheel);
+            if (focus & RECORDER_INPUT_MOUSE) {
+                InputWindow_mouseWheelEvent(inputWindow, e->wheel);
+            }
+        break;
+        // When a window event occurs
+        case SDL_WINDOWEVENT:
+            windowEvent(e);
         break;
     }
 }
@@ -419,52 +1237,33 @@ void pollEvents() {
     if (SDL_PollEvent(NULL) == 0) return;
     SDL_Event e;
     while (SDL_PollEvent(&e)) {
-        switch(e.type) {
-            // Quitting the game (on exit, ALT+F4, etc.)
-            case SDL_QUIT:
-                running = false;
-            return;
-            // When a key is pressed or released
-            case SDL_KEYUP:
-            case SDL_KEYDOWN:
-                if (isKeyFocused(window)) keyEvent(e.key);
-                if (isKeyFocused(inputWindow->window)) {
-                    InputWindow_keyEvent(inputWindow, e.key);
-                }
-            break;
-            // When mouse motion occurs
-            case SDL_MOUSEMOTION:
-                if (isMouseFocused(window)) mouseMotionEvent(e.motion);
-                if (isMouseFocused(inputWindow->window)) {
-                    InputWindow_mouseMotionEvent(inputWindow, e.motion);
-                }
-            break;
-            // When the mouse buttons are pressed
-            case SDL_MOUSEBUTTONUP:
-            case SDL_MOUSEBUTTONDOWN:
-                if (isMouseFocused(window)) mouseButtonEvent(e.button);
-                if (isMouseFocused(inputWindow->window)) {
-                    InputWindow_mouseButtonEvent(inputWindow, e.button);
-                }
-            break;
-            // When the mouse wheel is moved
-            case SDL_MOUSEWHEEL:
-                if (isMouseFocused(window)) mouseWheelEvent(e.wheel);
-            break;
-            // When a window event occurs
-            case SDL_WINDOWEVENT:
-                windowEvent(&e);
-            break;
-        }
+        int focus = currentFocus(&e);
+        if (recorder != NULL) Recorder_record(recorder, &e, focus);
+        handleEvent(&e, focus);
+        if (!running) return;
+    }
+}
+
+// Prints how long it has been since the last part of start up, or starts
+// the clock if there is no part given, with -startup-profile
+void startupPhase(const char* part) {
+    Uint64 now = SDL_GetPerformanceCounter();
+    if (part == NULL) startupStart = now;
+    if (startupProfile && part != NULL) {
+        double frequency = SDL_GetPerformanceFrequency();
+        printf("    %-12s %8.3f ms (%.3f ms in total)\n", part,
+                (now - startupLast) * 1000 / frequency, (now - startupStart) * 1000 / frequency);
     }
+    startupLast = now;
 }
 
 // Runs the main program loop
 void run() {
     // Allow the program to run
     running = true;
-    // Keep track of when the last update was
-    unsigned int lastUpdate = SDL_GetTicks();
+    // Keep track of when the last update was, starting a whole update
+    // ago so the first frame is drawn straight away
+    unsigned int lastUpdate = SDL_GetTicks() - UPDATE_DELTA_TIME;
     while (running) {
         // Poll for events
         pollEvents();
@@ -473,8 +1272,174 @@ void run() {
             lastUpdate += UPDATE_DELTA_TIME;
             update();
             draw();
+            if (recorder != NULL) Recorder_endFrame(recorder, 0);
+            if (startupProfile) {
+                startupPhase("first frame");
+                startupProfile = false;
+            }
+        }
+    }
+}
+
+// Runs the recorded events back one update at a time as fast as the
+// updates can go, timing each update with its events and drawing
+void replay() {
+    running = true;
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    while (running && !recorder->finished) {
+        // Only closing the window is taken from the real events
+        SDL_Event e;
+        while (SDL_PollEvent(&e)) {
+            if (e.type == SDL_QUIT) running = false;
+        }
+        Uint64 start = SDL_GetPerformanceCounter();
+        int focus, events = 0;
+        while (running && Recorder_next(recorder, &e, &focus)) {
+            handleEvent(&e, focus);
+            events++;
+        }
+        // The recording ended before this update
+        if (recorder->finished && events == 0) break;
+        update();
+        draw();
+        Uint64 end = SDL_GetPerformanceCounter();
+        if (startupProfile) {
+            startupPhase("first frame");
+            startupProfile = false;
+        }
+        Recorder_endFrame(recorder, (end - start) * 1000.0 / frequency);
+    }
+}
+
+// Draws the graph with the rasteriser at a multiple of the window size
+// and saves it to a file rather than a window
+bool renderToFile(const char* file, double scale) {
+    updateItems();
+    SceneBuilder_wait(sceneBuilder);
+    if (rasteriser != NULL) freeRasteriser(rasteriser);
+    rasteriser = initialiseRasteriser(NULL, WINDOW_WIDTH * scale, WINDOW_HEIGHT * scale, scale, threadPool);
+    rasterise = true;
+    Rasteriser_clear(rasteriser, (SDL_Color) { BG_R, BG_G, BG_B, 255 });
+    drawGraph();
+    Rasteriser_flush(rasteriser);
+    bool saved = Rasteriser_save(rasteriser, file);
+    // The rasteriser is the wrong size for the window now
+    freeRasteriser(rasteriser);
+    rasteriser = NULL;
+    return saved;
+}
+
+// Gets a random number in the range
+double randomRange(double min, double max) {
+    return min + (max - min) * rand() / RAND_MAX;
+}
+
+// Prints how the fast path compared with the reference, returning whether
+// it is close enough to use
+bool accuracyReport(const char* name, long count, Uint64 reference_ticks,
+        Uint64 fast_ticks, double max_error, double max_relative) {
+    double frequency = SDL_GetPerformanceFrequency();
+    bool accepted = max_relative <= ACCURACY_TOLERANCE;
+    printf("%s, %ld checked:\n", name, count);
+    printf("    reference : %.2f million per second\n",
+            count / (reference_ticks / frequency) / 1e6);
+    printf("    fast      : %.2f million per second\n",
+            count / (fast_ticks / frequency) / 1e6);
+    printf("    max error : %g (%g relative) %s\n",
+            max_error, max_relative, accepted ? "ok" : "TOO BIG");
+    return accepted;
+}
+
+// Checks the fast paths give the same results as the reference maths on
+// random views, points and systems, returning whether they all do
+bool accuracy(long n) {
+    srand(1);
+    long batches = n / ACCURACY_BATCH;
+    if (batches < 1) batches = 1;
+    Point points[ACCURACY_BATCH];
+    Tuple3 reference[ACCURACY_BATCH], fast[ACCURACY_BATCH];
+    Uint64 reference_ticks = 0, fast_ticks = 0;
+    double max_error = 0, max_relative = 0;
+
+    // projectTo against solving for every point in the view's basis
+    for (long i = 0; i < batches; i++) {
+        PolarVector pv = { randomRange(0.01, 5), randomRange(-2 * PI, 2 * PI),
+                randomRange(-2 * PI, 2 * PI) };
+        for (int j = 0; j < ACCURACY_BATCH; j++) {
+            points[j].x = randomRange(-4 * AXIS_LENGTH, 4 * AXIS_LENGTH);
+            points[j].y = randomRange(-4 * AXIS_LENGTH, 4 * AXIS_LENGTH);
+            points[j].z = randomRange(-4 * AXIS_LENGTH, 4 * AXIS_LENGTH);
+        }
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int j = 0; j < ACCURACY_BATCH; j++) referenceProjectTo(&reference[j], &pv, &points[j]);
+        Uint64 middle = SDL_GetPerformanceCounter();
+        ViewBasis b;
+        viewBasisFromPolar(&b, &pv);
+        for (int j = 0; j < ACCURACY_BATCH; j++) viewBasisProject(&fast[j], &b, &points[j]);
+        Uint64 end = SDL_GetPerformanceCounter();
+        reference_ticks += middle - start;
+        fast_ticks += end - middle;
+        for (int j = 0; j < ACCURACY_BATCH; j++) {
+            Vector size = { points[j].x, points[j].y, points[j].z };
+            double error = fmax(fabs(fast[j].a - reference[j].a),
+                    fmax(fabs(fast[j].b - reference[j].b), fabs(fast[j].c - reference[j].c)));
+            max_error = fmax(max_error, error);
+            max_relative = fmax(max_relative, error / norm(&size));
+        }
+    }
+    bool accepted = accuracyReport("projectTo", batches * ACCURACY_BATCH,
+            reference_ticks, fast_ticks, max_error, max_relative);
+
+    // Systems3 against directionTo, on systems far enough from singular
+    // that their answers are well defined
+    Systems3 sys;
+    initialiseSystems3(&sys);
+    Vector v[ACCURACY_BATCH], u[ACCURACY_BATCH], w[ACCURACY_BATCH];
+    long checked = 0;
+    reference_ticks = fast_ticks = 0;
+    max_error = max_relative = 0;
+    for (long i = 0; i < batches; i++) {
+        for (int j = 0; j < ACCURACY_BATCH; j++) {
+            v[j] = (Vector) { randomRange(-1, 1), randomRange(-1, 1), randomRange(-1, 1) };
+            u[j] = (Vector) { randomRange(-1, 1), randomRange(-1, 1), randomRange(-1, 1) };
+            w[j] = (Vector) { randomRange(-1, 1), randomRange(-1, 1), randomRange(-1, 1) };
+            points[j].x = randomRange(-4 * AXIS_LENGTH, 4 * AXIS_LENGTH);
+            points[j].y = randomRange(-4 * AXIS_LENGTH, 4 * AXIS_LENGTH);
+            points[j].z = randomRange(-4 * AXIS_LENGTH, 4 * AXIS_LENGTH);
+        }
+        bool solved[ACCURACY_BATCH];
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int j = 0; j < ACCURACY_BATCH; j++) {
+            solved[j] = directionTo(&reference[j], &v[j], &u[j], &w[j], &points[j]);
+        }
+        Uint64 middle = SDL_GetPerformanceCounter();
+        sys.count = 0;
+        for (int j = 0; j < ACCURACY_BATCH; j++) {
+            double m[9] = { v[j].x, u[j].x, w[j].x, v[j].y, u[j].y, w[j].y, v[j].z, u[j].z, w[j].z };
+            double r[3] = { points[j].x, points[j].y, points[j].z };
+            Systems3_add(&sys, m, r);
+        }
+        Systems3_solve(&sys);
+        Uint64 end = SDL_GetPerformanceCounter();
+        reference_ticks += middle - start;
+        fast_ticks += end - middle;
+        for (int j = 0; j < ACCURACY_BATCH; j++) {
+            Vector uw;
+            crossVector(&uw, &u[j], &w[j]);
+            double det = fabs(uw.x * v[j].x + uw.y * v[j].y + uw.z * v[j].z);
+            if (!solved[j] || sys.singular[j] || det < 0.1 * norm(&v[j]) * norm(&u[j]) * norm(&w[j])) continue;
+            Vector size = { reference[j].a, reference[j].b, reference[j].c };
+            double error = fmax(fabs(sys.x[0][j] - reference[j].a),
+                    fmax(fabs(sys.x[1][j] - reference[j].b), fabs(sys.x[2][j] - reference[j].c)));
+            max_error = fmax(max_error, error);
+            max_relative = fmax(max_relative, error / norm(&size));
+            checked++;
         }
     }
+    freeSystems3(&sys);
+    accepted &= accuracyReport("Systems3_solve", checked,
+            reference_ticks, fast_ticks, max_error, max_relative);
+    return accepted;
 }
 
 void test() {
@@ -526,6 +1491,127 @@ void test() {
     assert(t.a == -297);
     assert(t.b == -35.9073);
 
+    // niceStep
+    assert(niceStep(1) == 1);
+    assert(niceStep(1.5) == 2);
+    assert(niceStep(3) == 5);
+    assert(niceStep(7) == 10);
+    assert(niceStep(20) == 20);
+    assert(niceStep(0.03) == 0.05);
+    assert(fabs(niceStep(0.011) - 0.02) < 1e-12);
+    assert(niceStep(420) == 500);
+    assert(niceStep(0) == 0);
+    // planeGridStep
+    Tuple3 g_a = { 0, 0, 0 }, g_b = { 800, 0, 0 }, g_c = { 0, 20, 0 };
+    assert(planeGridStep(&g_a, &g_b) < planeGridStep(&g_a, &g_c));
+    assert(planeGridStep(&g_a, &g_a) == 0);
+    assert(1 / planeGridStep(&g_a, &g_c) <= PLANE_GRID_MAX_LINES + 1);
+
+    // Interpolating projected points matches projecting the interpolated point
+    Tuple3 s_a, s_b, s_c;
+    Point p_a = { 30, -45, 12 }, p_b = { -60, 15, 90 }, p_c = { -15, -15, 51 };
+    screenCoordinatesTo(&s_a, &p_a);
+    screenCoordinatesTo(&s_b, &p_b);
+    screenCoordinatesTo(&s_c, &p_c);
+    tuple3Lerp(&s_a, &s_a, &s_b, 0.5);
+    assert(fabs(s_c.a - s_a.a) < 1e-9);
+    assert(fabs(s_c.b - s_a.b) < 1e-9);
+    assert(fabs(s_c.c - s_a.c) < 1e-9);
+
+    // The depth grows towards the viewer
+    vectorFromPolar(&v_a, view);
+    p_a = (Point) { v_a.x, v_a.y, v_a.z };
+    p_b = (Point) { -v_a.x, -v_a.y, -v_a.z };
+    screenCoordinatesTo(&s_a, &p_a);
+    screenCoordinatesTo(&s_b, &p_b);
+    assert(s_a.c > s_b.c);
+
+    // Rasteriser hides lines behind filled triangles
+    Rasteriser* r = initialiseRasteriser(NULL, 8, 8, 1, threadPool);
+    Tuple3 l_a = { 0, 2, -10 }, l_b = { 7, 2, -10 };
+    s_a = (Tuple3) { -1, -1, 0 };
+    s_b = (Tuple3) { 20, -1, 0 };
+    s_c = (Tuple3) { -1, 20, 0 };
+    for (int i = 0; i < 2; i++) {
+        Rasteriser_clear(r, (SDL_Color) { 0, 0, 0, 255 });
+        Rasteriser_setColor(r, (SDL_Color) { 255, 0, 0, 255 });
+        Rasteriser_fillTriangle(r, &s_a, &s_b, &s_c);
+        Rasteriser_setColor(r, (SDL_Color) { 0, 255, 0, 255 });
+        // The second time the line is in front of the triangle
+        l_a.c = l_b.c = i == 0 ? -10 : 10;
+        Rasteriser_drawLine(r, &l_a, &l_b);
+        Rasteriser_flush(r);
+        assert((r->pixels[2 * 8 + 3] == 0xFF00FF00) == (i == 1));
+        assert(r->pixels[7 * 8 + 7] != 0xFF000000);
+    }
+    // Later flushes draw on top of the earlier ones, keeping their depths
+    Uint32 kept = r->pixels[5 * 8 + 3];
+    l_a = (Tuple3) { 0, 5, -10 };
+    l_b = (Tuple3) { 7, 5, -10 };
+    Rasteriser_drawLine(r, &l_a, &l_b);
+    Rasteriser_flush(r);
+    assert(r->pixels[2 * 8 + 3] == 0xFF00FF00 && r->pixels[5 * 8 + 3] == kept);
+    l_a.c = l_b.c = 10;
+    Rasteriser_drawLine(r, &l_a, &l_b);
+    Rasteriser_flush(r);
+    assert(r->pixels[5 * 8 + 3] == 0xFF00FF00);
+    // Lines are clipped to the framebuffer
+    Rasteriser_clear(r, (SDL_Color) { 0, 0, 0, 255 });
+    l_a = (Tuple3) { -100, -50, 0 };
+    l_b = (Tuple3) { 100, 58, 0 };
+    Rasteriser_drawLine(r, &l_a, &l_b);
+    l_a = (Tuple3) { -100, -50, 0 };
+    l_b = (Tuple3) { -10, 50, 0 };
+    Rasteriser_drawLine(r, &l_a, &l_b);
+    Rasteriser_flush(r);
+    // The first crosses the framebuffer at y = 4 + 0.54x and leaves the
+    // bottom before the last column, the second never reaches it
+    for (int x = 0; x < 7; x++) {
+        int y = 4 + 0.54 * x + 0.5;
+        bool found = false;
+        for (int dy = -1; dy <= 1; dy++) {
+            if (y + dy >= 0 && y + dy < 8 && r->pixels[(y + dy) * 8 + x] == 0xFF00FF00) found = true;
+        }
+        assert(found);
+    }
+    for (int y = 0; y < 3; y++) {
+        for (int x = 0; x < 8; x++) assert(r->pixels[y * 8 + x] == 0xFF000000);
+    }
+    assert(r->pixels[7 * 8 + 7] == 0xFF000000);
+    freeRasteriser(r);
+
+    // Lines crossing several tiles are drawn in all of them
+    r = initialiseRasteriser(NULL, RASTERISER_TILE_SIZE * 3, RASTERISER_TILE_SIZE * 2, 0.5, threadPool);
+    Rasteriser_clear(r, (SDL_Color) { 0, 0, 0, 255 });
+    Rasteriser_setColor(r, (SDL_Color) { 255, 255, 255, 255 });
+    l_a = (Tuple3) { 0, 0, 0 };
+    l_b = (Tuple3) { RASTERISER_TILE_SIZE * 6, RASTERISER_TILE_SIZE * 4, 0 };
+    Rasteriser_drawLine(r, &l_a, &l_b);
+    Rasteriser_flush(r);
+    for (int x = 0; x < RASTERISER_TILE_SIZE * 3; x += 3) {
+        int y = x * 2 / 3;
+        bool found = false;
+        for (int dy = -1; dy <= 1; dy++) {
+            if (y + dy < 0 || y + dy >= RASTERISER_TILE_SIZE * 2) continue;
+            if (r->pixels[(y + dy) * r->width + x] == 0xFFFFFFFF) found = true;
+        }
+        assert(found);
+    }
+    freeRasteriser(r);
+
+    // arrowHead
+    Point ah_ends[2], ah_tip = { 0, -100, 0 };
+    v_a = (Vector) { 0, -100, 0 };
+    arrowHead(ah_ends, &ah_tip, &v_a, 0.05);
+    assert(ah_ends[0].x == 5 && ah_ends[0].y == -95 && ah_ends[0].z == 0);
+    assert(ah_ends[1].x == -5 && ah_ends[1].y == -95 && ah_ends[1].z == 0);
+    v_a = (Vector) { 3, 4, 0 };
+    arrowHead(ah_ends, &ah_tip, &v_a, 0.2);
+    for (int k = 0; k < 2; k++) {
+        Vector back = { ah_ends[k].x - ah_tip.x, ah_ends[k].y - ah_tip.y, ah_ends[k].z - ah_tip.z };
+        assert(fabs(norm(&back) - sqrt(2)) < 1e-12 && fabs(back.x * 3 + back.y * 4 + 5) < 1e-12);
+    }
+
     // norm
     v_a = (Vector) { 2, -3, 92 };
     assert(norm(&v_a) == 7 * sqrt(173));
@@ -578,6 +1664,505 @@ void test() {
     assert(v_a.y == 0);
     assert(v_a.z == 0);
     
+    // Picker
+    Picker* pk = initialisePicker(100, 100);
+    s_a = (Tuple3) { 10, 10, 0 };
+    s_b = (Tuple3) { 90, 90, 0 };
+    Picker_addSegment(pk, &s_a, &s_b, 3);
+    s_a = (Tuple3) { -50, 80, 0 };
+    s_b = (Tuple3) { 500, 80, 0 };
+    Picker_addSegment(pk, &s_a, &s_b, 5);
+    s_a = (Tuple3) { 200, 200, 0 };
+    s_b = (Tuple3) { 300, 300, 0 };
+    Picker_addSegment(pk, &s_a, &s_b, 7);
+    Picker_build(pk);
+    assert(Picker_pick(pk, 50, 52, NULL) == 3);
+    assert(Picker_pick(pk, 50, 70, NULL) == -1);
+    assert(Picker_pick(pk, 2, 79, NULL) == 5);
+    assert(Picker_pick(pk, 70, 79, NULL) == 5);
+    assert(Picker_pick(pk, 81, 81, NULL) == 3);
+    assert(Picker_pick(pk, 99, 99, NULL) == -1);
+    // The segment closest to the viewer wins, unless the depth buffer
+    // hides it
+    Picker_clear(pk);
+    s_a = (Tuple3) { 0, 50, 1 };
+    s_b = (Tuple3) { 100, 50, 1 };
+    Picker_addSegment(pk, &s_a, &s_b, 2);
+    s_a = (Tuple3) { 0, 52, 5 };
+    s_b = (Tuple3) { 100, 52, 5 };
+    Picker_addSegment(pk, &s_a, &s_b, 4);
+    Picker_build(pk);
+    float* pk_depth = malloc(sizeof(float) * 100 * 100);
+    for (int i = 0; i < 100 * 100; i++) pk_depth[i] = i < 100 * 52 ? 1 : 10;
+    assert(Picker_pick(pk, 50, 50, NULL) == 4);
+    assert(Picker_pick(pk, 50, 50, pk_depth) == 2);
+    for (int i = 0; i < 100 * 100; i++) pk_depth[i] = 10;
+    assert(Picker_pick(pk, 50, 50, pk_depth) == -1);
+    free(pk_depth);
+    Picker_clear(pk);
+    Picker_build(pk);
+    assert(Picker_pick(pk, 50, 50, NULL) == -1);
+    freePicker(pk);
+
+    // parseItem / itemEquals
+    Item i_a, i_b;
+    parseItem(&i_a, "plane 1 2 3 4");
+    assert(i_a.type == ITEM_PLANE);
+    assert(i_a.values[0] == 1 && i_a.values[3] == 4);
+    parseItem(&i_b, "plane 1.0 2 3.00 4");
+    assert(itemEquals(&i_a, &i_b));
+    parseItem(&i_b, "plane 1 2 3 4 5");
+    assert(itemEquals(&i_a, &i_b));
+    parseItem(&i_b, "plane 1 2 3 5");
+    assert(!itemEquals(&i_a, &i_b));
+    parseItem(&i_b, "point 1 2 3 4");
+    assert(!itemEquals(&i_a, &i_b));
+    parseItem(&i_a, "poi");
+    assert(i_a.type == ITEM_NONE);
+    parseItem(&i_b, "");
+    assert(itemEquals(&i_a, &i_b));
+    parseItem(&i_a, "line 1 2");
+    assert(i_a.type == ITEM_LINE);
+    assert(i_a.values[1] == 2 && i_a.values[2] == 0);
+    parseItem(&i_a, "planex 1 2 3 4");
+    assert(i_a.type == ITEM_NONE);
+    parseItem(&i_a, "pointer 1 2 3");
+    assert(i_a.type == ITEM_NONE && i_a.command == NULL);
+
+    // findCommand
+    for (int i = 1; i < commandCount; i++) assert(strcmp(commands[i - 1].name, commands[i].name) < 0);
+    for (int i = 0; i < commandCount; i++) {
+        assert(findCommand(commands[i].name) == &commands[i]);
+        assert(commands[i].values <= MAX_ITEM_VALUES);
+    }
+    assert(findCommand("a") == NULL && findCommand("zzz") == NULL && findCommand("plan") == NULL);
+
+    // GapBuffer
+    GapBuffer gb;
+    initialiseGapBuffer(&gb);
+    GapBuffer_insert(&gb, 0, "pane", 4);
+    GapBuffer_insert(&gb, 1, "l", 1);
+    assert(strcmp(GapBuffer_string(&gb), "plane") == 0);
+    GapBuffer_insert(&gb, 5, " 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15", 35);
+    assert(GapBuffer_length(&gb) == 40);
+    GapBuffer_delete(&gb, 0, 6);
+    assert(strncmp(GapBuffer_string(&gb), "1 2 3", 5) == 0);
+    GapBuffer_clear(&gb);
+    assert(GapBuffer_length(&gb) == 0 && GapBuffer_string(&gb)[0] == '\0');
+    freeGapBuffer(&gb);
+
+    // InputWindow_paste
+    inputWindow->caret_index = 0;
+    inputWindow->caret_location = 0;
+    InputWindow_paste(inputWindow, "point 1 2 3");
+    assert(inputWindow->caret_location == 11);
+    inputWindow->caret_location = 0;
+    InputWindow_paste(inputWindow, "line 1\r\nplane\tx\r1\x01\nscale ");
+    assert(strcmp(InputWindow_getLine(inputWindow, 0), "line 1") == 0);
+    // Tabs and carriage returns within a line separate values
+    assert(strcmp(InputWindow_getLine(inputWindow, 1), "plane x 1") == 0);
+    assert(strcmp(InputWindow_getLine(inputWindow, 2), "scale point 1 2 3") == 0);
+    assert(inputWindow->caret_index == 2 && inputWindow->caret_location == 6);
+    inputWindow->caret_index = 0;
+    inputWindow->caret_location = 6;
+    for (int i = 0; i < MAX_ITEMS; i++) InputWindow_dropChanged(inputWindow, i);
+    InputWindow_paste(inputWindow, "\n");
+    // Only the items that moved down changed
+    assert(InputWindow_dropChanged(inputWindow, 3) && !InputWindow_dropChanged(inputWindow, 4));
+    assert(strcmp(InputWindow_getLine(inputWindow, 1), "") == 0);
+    assert(strcmp(InputWindow_getLine(inputWindow, 2), "plane x 1") == 0);
+    assert(strcmp(InputWindow_getLine(inputWindow, 3), "scale point 1 2 3") == 0);
+    // Lines that would push items off the end are left out rather than
+    // joined onto the last item
+    inputWindow->caret_index = MAX_ITEMS - 3;
+    inputWindow->caret_location = 0;
+    InputWindow_paste(inputWindow, "point 1 0 0\npoint 2 0 0\npoint 3 0 0\npoint 4 0 0");
+    assert(strcmp(InputWindow_getLine(inputWindow, MAX_ITEMS - 3), "point 1 0 0") == 0);
+    assert(strcmp(InputWindow_getLine(inputWindow, MAX_ITEMS - 1), "point 3 0 0") == 0);
+    assert(inputWindow->caret_index == MAX_ITEMS - 1 && strcmp(InputWindow_getLine(inputWindow, 3), "scale point 1 2 3") == 0);
+    // With the last item used no new items fit
+    inputWindow->caret_index = 0;
+    InputWindow_paste(inputWindow, "\n");
+    assert(strcmp(InputWindow_getLine(inputWindow, 3), "scale point 1 2 3") == 0);
+    assert(strcmp(InputWindow_getLine(inputWindow, MAX_ITEMS - 1), "point 3 0 0") == 0);
+    for (int i = MAX_ITEMS - 3; i < MAX_ITEMS; i++) {
+        GapBuffer* g = &inputWindow->input[i];
+        GapBuffer_delete(g, 0, GapBuffer_length(g));
+    }
+
+    // Systems3
+    Systems3 sys;
+    initialiseSystems3(&sys);
+    for (int i = 0; i < 100; i++) {
+        double m[9] = { 2, 1, -1, -3, -1, 2, -2, 1, 2 };
+        double r[3] = { 8, -11, -3 };
+        Systems3_add(&sys, m, r);
+    }
+    double m_s[9] = { 1, 2, 3, 2, 4, 6, 0, 0, 1 };
+    double r_s[3] = { 1, 2, 3 };
+    assert(Systems3_add(&sys, m_s, r_s) == 100);
+    Systems3_solve(&sys);
+    for (int i = 0; i < 100; i++) {
+        assert(!sys.singular[i]);
+        assert(fabs(sys.x[0][i] - 2) < 1e-12);
+        assert(fabs(sys.x[1][i] - 3) < 1e-12);
+        assert(fabs(sys.x[2][i] + 1) < 1e-12);
+    }
+    assert(sys.singular[100] && sys.x[0][100] == 0);
+    freeSystems3(&sys);
+
+    // findIntersections
+    Intersections in;
+    Item in_items[5];
+    initialiseIntersections(&in);
+    parseItem(&in_items[0], "plane 1 0 0 1");
+    parseItem(&in_items[1], "plane 0 1 0 2");
+    parseItem(&in_items[2], "plane 0 0 1 3");
+    parseItem(&in_items[3], "plane 2 0 0 5");
+    parseItem(&in_items[4], "line 0 0 0 1 1 1");
+    findIntersections(&in, in_items, 5);
+    // The parallel planes meet nothing
+    assert(in.line_count == 5);
+    assert(in.point_count == 4 + 2);
+    assert(in.line_points[0].x == 1 && in.line_points[0].y == 2 && in.line_points[0].z == 0);
+    assert(in.points[0].x == 1 && in.points[0].y == 1 && in.points[0].z == 1);
+    assert(fabs(in.points[4].x - 1) < 1e-12 && fabs(in.points[4].z - 3) < 1e-12);
+    freeIntersections(&in);
+
+    // SceneBuilder
+    SceneBuilder* sb = initialiseSceneBuilder();
+    assert(!SceneBuilder_swap(sb));
+    SceneBuilder_setLine(sb, 2, "point 1 2 3");
+    SceneBuilder_setLine(sb, 5, "plane 1 1 1 1");
+    SceneBuilder_submit(sb);
+    assert(SceneBuilder_wait(sb));
+    assert(sb->front->items[2].type == ITEM_POINT && sb->front->items[2].values[2] == 3);
+    assert(sb->front->items[5].type == ITEM_PLANE && sb->front->items[0].type == ITEM_NONE);
+    SceneBuilder_setLine(sb, 2, "point 1.0 2 3");
+    assert(!SceneBuilder_wait(sb));
+    for (int i = 0; i < 100; i++) {
+        SceneBuilder_setLine(sb, 7, i % 2 ? "line 1 2 3 4 5 6" : "point 0 0 0");
+        SceneBuilder_submit(sb);
+        SceneBuilder_swap(sb);
+    }
+    SceneBuilder_wait(sb);
+    assert(sb->front->items[7].type == ITEM_LINE && sb->front->items[5].type == ITEM_PLANE);
+    // Scenes count up to their last item that isn't empty
+    assert(sb->front->count == 8);
+    SceneBuilder_setLine(sb, 7, "");
+    assert(SceneBuilder_wait(sb) && sb->front->count == 6);
+    SceneBuilder_setLine(sb, 5, "");
+    SceneBuilder_setLine(sb, 2, "");
+    assert(SceneBuilder_wait(sb) && sb->front->count == 0);
+    SceneBuilder_setLine(sb, 3, "point 1 1 1");
+    assert(SceneBuilder_wait(sb) && sb->front->count == 4 && sb->front->items[7].type == ITEM_NONE);
+    freeSceneBuilder(sb);
+
+    // Quadrics
+    Item q;
+    parseItem(&q, "cylinder 1 2 3 0 0 4 0.5");
+    assert(q.type == ITEM_CYLINDER && q.values[6] == 0.5);
+    parseItem(&q, "sphere 1 2 3 4 5");
+    assert(q.type == ITEM_SPHERE && q.values[3] == 4 && q.values[4] == 0);
+    parseItem(&q, "ellipsoid 0 0 0 1 2 3");
+    assert(q.type == ITEM_ELLIPSOID && q.values[5] == 3);
+
+    // compileExpression / Expression_evaluate
+    Expression ex;
+    ExpressionStack* ex_stack = malloc(sizeof(ExpressionStack));
+    double ex_x[300], ex_y[300], ex_z[300], ex_out[300];
+    for (int i = 0; i < 300; i++) {
+        ex_x[i] = i;
+        ex_y[i] = -i;
+        ex_z[i] = 0.5;
+    }
+    assert(compileExpression(&ex, "2*x-y^2/4+sin(pi*z)"));
+    Expression_evaluate(&ex, ex_x, ex_y, ex_z, 0, ex_out, 300, ex_stack);
+    for (int i = 0; i < 300; i++) assert(fabs(ex_out[i] - (2.0 * i - i * i / 4.0 + 1)) < 1e-9);
+    assert(compileExpression(&ex, "-x^2"));
+    Expression_evaluate(&ex, ex_x + 3, ex_y, ex_z, 0, ex_out, 1, ex_stack);
+    assert(ex_out[0] == -9);
+    assert(compileExpression(&ex, "3"));
+    assert(!compileExpression(&ex, "2x"));
+    assert(!compileExpression(&ex, "sin x"));
+    assert(!compileExpression(&ex, "(x+1"));
+    assert(!compileExpression(&ex, ""));
+    assert(compileExpression(&ex, "x*t") && ex.variables == (EXPRESSION_X | EXPRESSION_T));
+    Expression_evaluate(&ex, ex_x + 3, ex_y, ex_z, 2, ex_out, 1, ex_stack);
+    assert(ex_out[0] == 6);
+    assert(Expression_evaluateAt(&ex, 3, 0, 0, 2) == 6);
+    assert(compileExpression(&ex, "2*x-y^2/4+sin(pi*z)"));
+    assert(fabs(Expression_evaluateAt(&ex, 4, -4, 0.5, 0) - 5) < 1e-9);
+    free(ex_stack);
+
+    // parseValues
+    Item an_a, an_b;
+    parseItem(&an_a, "point cos(t) sin(t) t");
+    assert(an_a.type == ITEM_POINT && an_a.data != NULL && an_a.data->timed);
+    assert(an_a.values[0] == 1 && an_a.values[1] == 0 && an_a.values[2] == 0);
+    an_a.data->animate(an_a.data, PI / 2, an_a.values);
+    assert(fabs(an_a.values[0]) < 1e-9 && fabs(an_a.values[1] - 1) < 1e-9 && an_a.values[2] == PI / 2);
+    parseItem(&an_b, "point cos(t) sin(t) t");
+    assert(!itemEquals(&an_a, &an_b));
+    an_b.data->animate(an_b.data, PI / 2, an_b.values);
+    assert(itemEquals(&an_a, &an_b));
+    releaseItem(&an_b);
+    parseItem(&an_b, "point cos(t) sin(t) 2*t");
+    an_b.data->animate(an_b.data, PI / 2, an_b.values);
+    assert(!itemEquals(&an_a, &an_b));
+    releaseItem(&an_b);
+    releaseItem(&an_a);
+    // Values that don't change with time are only numbers
+    parseItem(&an_a, "sphere 2*pi 0 0 1");
+    assert(an_a.type == ITEM_SPHERE && an_a.data == NULL && an_a.values[0] == 2 * PI && an_a.values[3] == 1);
+    parseItem(&an_a, "point 1 x 3");
+    assert(an_a.type == ITEM_POINT && an_a.data == NULL && an_a.values[0] == 1 && an_a.values[2] == 0);
+
+    // parseField
+    Item fi_a, fi_b;
+    parseItem(&fi_a, "field -y x 0 5");
+    assert(fi_a.type == ITEM_FIELD);
+    Field* fi = (Field*) fi_a.data;
+    // The samples on the z axis have no arrow
+    assert(fi->samples == 5 && fi->arrow_count == 5 * 5 * 5 - 5);
+    assert(fi->vertices[0].x == -AXIS_LENGTH && fi->vertices[0].y == -AXIS_LENGTH);
+    parseItem(&fi_b, "field -y x 0 5");
+    assert(itemEquals(&fi_a, &fi_b));
+    releaseItem(&fi_b);
+    parseItem(&fi_b, "field -y x 1 5");
+    assert(!itemEquals(&fi_a, &fi_b));
+    releaseItem(&fi_b);
+    parseItem(&fi_b, "field -y x");
+    assert(fi_b.type == ITEM_NONE && fi_b.data == NULL);
+    releaseItem(&fi_a);
+
+    // parseCloud, from a file in the temporary directory removed before
+    // anything is asserted
+    char csv_name[L_tmpnam], csv_item[L_tmpnam + 16];
+    assert(tmpnam(csv_name) != NULL);
+    FILE* csv = fopen(csv_name, "w");
+    assert(csv != NULL);
+    fprintf(csv, "x,y,z\n1,2,3\n4, 5, 6, 7\r\nbad\n");
+    for (int i = 0; i < CLOUD_BUFFER; i++) fputc('9', csv);
+    fprintf(csv, "\n-1;-2;-3");
+    fclose(csv);
+    snprintf(csv_item, sizeof(csv_item), "path %s", csv_name);
+    parseItem(&fi_a, csv_item);
+    remove(csv_name);
+    assert(fi_a.type == ITEM_PATH);
+    Cloud* cl = (Cloud*) fi_a.data;
+    // The header, bad and overlong lines are skipped
+    assert(cl->count == 3);
+    assert(cl->points[1].x == 4 && cl->points[1].z == 6 && cl->points[2].y == -2);
+    releaseItem(&fi_a);
+    snprintf(csv_item, sizeof(csv_item), "scatter %s", csv_name);
+    parseItem(&fi_a, csv_item);
+    assert(fi_a.type == ITEM_NONE);
+
+    // ViewCache
+    ViewCache* vc = initialiseViewCache();
+    Tuple3 vc_a = { 1, 2, 3 }, vc_b = { 4, 5, 6 };
+    int vc_offsets[4] = { -5, -5, 5, 5 };
+    for (int i = 0; i < 2000; i++) ViewCache_add(vc, &vc_a, &vc_b, NULL, i, (SDL_Color) { 1, 2, 3, 4 });
+    ViewCache_add(vc, &vc_a, &vc_a, vc_offsets, -1, (SDL_Color) { 0, 0, 0, 0 });
+    assert(vc->count == 2001 && vc->segments[1999].item == 1999);
+    assert(vc->segments[5].b.z == 6 && vc->segments[5].offsets[3] == 0);
+    assert(vc->segments[2000].offsets[0] == -5 && vc->segments[2000].b.x == 1);
+    ViewCache_clear(vc);
+    assert(vc->count == 0);
+    freeViewCache(vc);
+
+    // stratumOrder / drawCloud
+    bool st_seen[PROGRESSIVE_STRATA] = { false };
+    for (int k = 0; k < PROGRESSIVE_STRATA; k++) st_seen[stratumOrder(k)] = true;
+    for (int k = 0; k < PROGRESSIVE_STRATA; k++) assert(st_seen[k]);
+    assert(stratumOrder(0) == 0 && stratumOrder(1) == PROGRESSIVE_STRATA / 2);
+    // Every stratum together draws each point and segment once
+    Point st_points[37];
+    for (int i = 0; i < 37; i++) st_points[i] = (Point) { i, 0, 0 };
+    Cloud st_cloud = { .count = 37, .points = st_points };
+    ViewCache* st_cache = initialiseViewCache();
+    ViewCache* st_view = viewCache;
+    viewCache = st_cache;
+    capturing = true;
+    strata = PROGRESSIVE_STRATA;
+    for (stratum = 0; stratum < PROGRESSIVE_STRATA; stratum++) drawCloud(&st_cloud, true);
+    assert(viewCache->count == 36);
+    for (stratum = 0; stratum < PROGRESSIVE_STRATA; stratum++) drawCloud(&st_cloud, false);
+    assert(viewCache->count == 36 + 2 * 37);
+    stratum = 0;
+    strata = 1;
+    // A vertical plane in the split views gets both families of grid
+    // lines, from how big it is in the views it faces
+    ViewCache_clear(viewCache);
+    updateSplitAxes();
+    Plane st_plane = { 1, 0, 0, 0 };
+    drawPlane(&st_plane);
+    int st_along_y = 0, st_along_z = 0;
+    for (int i = 0; i < viewCache->count; i++) {
+        Point* a = &viewCache->segments[i].a;
+        Point* b = &viewCache->segments[i].b;
+        assert(fabs(a->x) < 1e-9 && fabs(b->x) < 1e-9);
+        if (fabs(a->y - b->y) < 1e-9) st_along_z++;
+        if (fabs(a->z - b->z) < 1e-9) st_along_y++;
+    }
+    assert(st_along_y > 2 && st_along_z > 2 && st_along_y + st_along_z == viewCache->count);
+    assert(st_along_y - 2 <= PLANE_GRID_MAX_LINES && st_along_z - 2 <= PLANE_GRID_MAX_LINES);
+    capturing = false;
+    viewCache = st_view;
+    freeViewCache(st_cache);
+
+    // DensityMap
+    DensityMap* dm = initialiseDensityMap(NULL, 64, 48, threadPool);
+    ViewBasis dm_basis;
+    PolarVector dm_view = { 1, 0.3, 0.2 };
+    viewBasisFromPolar(&dm_basis, &dm_view);
+    Point* dm_points = malloc(sizeof(Point) * 3 * DENSITY_CHUNK);
+    for (int i = 0; i < 3 * DENSITY_CHUNK; i++) dm_points[i] = (Point) { 0, 0, 0 };
+    dm_points[5] = (Point) { 1e9, 0, 0 };
+    dm_points[6] = (Point) { NAN, 0, 0 };
+    DensityMap_clear(dm);
+    DensityMap_addPoints(dm, dm_points, 3 * DENSITY_CHUNK, &dm_basis, 1);
+    DensityMap_addPoints(dm, dm_points, 10, &dm_basis, 1);
+    DensityMap_resolve(dm);
+    // The origin lands in the middle, every point but the two skipped
+    assert(dm->count == 3 * DENSITY_CHUNK + 10);
+    assert(dm->counts[24 * 64 + 32] == 3 * DENSITY_CHUNK + 10 - 4);
+    assert(dm->pixels[24 * 64 + 32] == dm->levels[DENSITY_LEVELS - 1] && dm->pixels[0] == 0);
+    DensityMap_clear(dm);
+    DensityMap_resolve(dm);
+    assert(dm->count == 0 && dm->pixels[24 * 64 + 32] == 0);
+    free(dm_points);
+    freeDensityMap(dm);
+
+    // Stream, from a temporary file removed before anything is asserted
+    char st_name[L_tmpnam];
+    assert(tmpnam(st_name) != NULL);
+    FILE* st_file = fopen(st_name, "w");
+    assert(st_file != NULL);
+    for (int i = 0; i < STREAM_RING_SIZE + 1000; i++) fprintf(st_file, "point %d 0 0\n", i);
+    fprintf(st_file, "sphere 0 0 0 1\npoint t 0 0\nbad\nline 1 2 3 4 5 6\n");
+    for (int i = 0; i < STREAM_LINE_LENGTH; i++) fputc('7', st_file);
+    fprintf(st_file, "\nplane 1 2 3 4");
+    fclose(st_file);
+    Stream* st = initialiseStream(st_name, 3);
+    int st_moved = 0;
+    while (st != NULL && SDL_AtomicGet(&st->finished) == 0) st_moved += Stream_update(st);
+    if (st != NULL) st_moved += Stream_update(st);
+    remove(st_name);
+    assert(st != NULL);
+    // Only plain points, lines and planes are kept, the newest last
+    assert(st_moved == STREAM_RING_SIZE + 1000 + 2 && st->count == 3);
+    assert(Stream_get(st, 0)->type == ITEM_POINT && Stream_get(st, 0)->values[0] == STREAM_RING_SIZE + 999);
+    assert(Stream_get(st, 1)->type == ITEM_LINE && Stream_get(st, 1)->values[5] == 6);
+    assert(Stream_get(st, 2)->type == ITEM_PLANE && Stream_get(st, 2)->values[3] == 4);
+    freeStream(st);
+    assert(initialiseStream("no/such/stream", 3) == NULL);
+
+    // Exporter, to a temporary file removed before anything is asserted
+    char ep_name[L_tmpnam];
+    assert(tmpnam(ep_name) != NULL);
+    Exporter* ep = initialiseExporter(ep_name, 100, 100, (SDL_Color) { 1, 2, 3, 255 });
+    SDL_Color ep_red = { 255, 0, 0, 255 }, ep_blue = { 0, 0, 255, 255 };
+    Tuple3 ep_a = { 10, 10, 0 }, ep_b = { 20, 20, 0 }, ep_c = { 30, 30, 0 }, ep_d = { 0, 10, 0 };
+    Tuple3 ep_far = { 500, 500, 0 }, ep_farther = { 600, 700, 0 }, ep_left = { -50, 50, 0 }, ep_mid = { 50, 50, 0 };
+    bool ep_finished = false;
+    char ep_text[1024] = "";
+    if (ep != NULL) {
+        // Carrying on in a straight line from either end merges
+        Exporter_addLine(ep, &ep_a, &ep_b, ep_red);
+        Exporter_addLine(ep, &ep_b, &ep_c, ep_red);
+        Exporter_addLine(ep, &ep_a, &ep_d, ep_red);
+        Exporter_addLine(ep, &ep_far, &ep_farther, ep_red);
+        Exporter_addLine(ep, &ep_left, &ep_mid, ep_blue);
+        ep_finished = Exporter_finish(ep);
+        freeExporter(ep);
+        FILE* ep_file = fopen(ep_name, "r");
+        if (ep_file != NULL) {
+            size_t ep_length = fread(ep_text, 1, sizeof(ep_text) - 1, ep_file);
+            ep_text[ep_length] = '\0';
+            fclose(ep_file);
+        }
+    }
+    remove(ep_name);
+    assert(ep != NULL && ep_finished);
+    assert(strstr(ep_text, "fill=\"#010203\"") != NULL);
+    assert(strstr(ep_text, "<path stroke=\"#ff0000\" d=\"M10.00 10.00 L30.00 30.00 M10.00 10.00 L0.00 10.00\"/>") != NULL);
+    // Off the canvas is dropped and across its edge is clipped
+    assert(strstr(ep_text, "500") == NULL);
+    assert(strstr(ep_text, "<path stroke=\"#0000ff\" d=\"M0.00 50.00 L50.00 50.00\"/>") != NULL);
+    assert(initialiseExporter("no/such/directory/graph.svg", 100, 100, ep_red) == NULL);
+
+    // Bounds
+    Bounds bd, bd_serial;
+    initialiseBounds(&bd);
+    initialiseBounds(&bd_serial);
+    assert(Bounds_empty(&bd));
+    int bd_count = 3 * BOUNDS_CHUNK + 17;
+    Point* bd_points = malloc(sizeof(Point) * bd_count);
+    for (int i = 0; i < bd_count; i++) {
+        bd_points[i] = (Point) { randomRange(-5, 5), randomRange(-1e5, 1e5), randomRange(0, 1) };
+        Bounds_addPoint(&bd_serial, &bd_points[i]);
+    }
+    bd_points[bd_count - 1] = (Point) { 7, NAN, -3 };
+    Bounds_addPoint(&bd_serial, &bd_points[bd_count - 1]);
+    ThreadPool* bd_pool = initialiseThreadPool(4);
+    Bounds_addPoints(&bd, bd_points, bd_count, bd_pool);
+    freeThreadPool(bd_pool);
+    free(bd_points);
+    assert(bd.min.x == bd_serial.min.x && bd.max.y == bd_serial.max.y);
+    assert(bd.max.x == 7 && bd.min.z == -3);
+    Point bd_centre;
+    double bd_radius;
+    initialiseBounds(&bd);
+    Point bd_c = { 1, 2, 3 };
+    Bounds_addBox(&bd, &bd_c, 3, -4, 0);
+    Bounds_sphere(&bd, &bd_centre, &bd_radius);
+    assert(bd_centre.x == 1 && bd_centre.y == 2 && bd_radius == 5);
+
+    // animateItems
+    SceneBuilder_setLine(sceneBuilder, 0, "point cos(t) 0 0");
+    SceneBuilder_wait(sceneBuilder);
+    animationTime = PI - UPDATE_DELTA_TIME / 1000.0;
+    animateItems();
+    // Only the drawn copies move, never the scene the worker copies from
+    assert(fabs(sceneItems()[0].values[0] + 1) < 1e-9 && sceneBuilder->front->items[0].values[0] == 1);
+    SceneBuilder_setLine(sceneBuilder, 0, "");
+    SceneBuilder_wait(sceneBuilder);
+    assert(sceneItems()[0].type == ITEM_NONE);
+    animationTime = 0;
+
+    // fitView
+    SceneBuilder_setLine(sceneBuilder, 0, "point 300 400 0");
+    SceneBuilder_setLine(sceneBuilder, 1, "sphere 0 0 0 10");
+    SceneBuilder_wait(sceneBuilder);
+    fitView();
+    // The point furthest out is 500 from the origin
+    assert(axisLength >= 500 && axisLength < 510);
+    assert(fabs(view->r * FIT_MARGIN * WINDOW_HEIGHT_MID - AXIS_LABEL_SCALE * axisLength) < 1e-9);
+    SceneBuilder_setLine(sceneBuilder, 0, "");
+    SceneBuilder_setLine(sceneBuilder, 1, "");
+    SceneBuilder_wait(sceneBuilder);
+    fitView();
+    assert(axisLength == AXIS_LENGTH);
+
+    // MeshSet
+    MeshSet* ms = initialiseMeshSet();
+    assert(meshLevel(0) == 0 && meshLevel(1e9) == MESH_LEVELS - 1);
+    assert(meshLevel(10) <= meshLevel(100));
+    for (int l = 0; l < MESH_LEVELS; l++) {
+        Mesh* sphere = &ms->meshes[MESH_SPHERE][l];
+        Mesh* cylinder = &ms->meshes[MESH_CYLINDER][l];
+        for (int i = 0; i < sphere->vertex_count; i++) {
+            Point* pt = &sphere->vertices[i];
+            assert(fabs(pt->x * pt->x + pt->y * pt->y + pt->z * pt->z - 1) < 1e-12);
+        }
+        for (int i = 0; i < 2 * cylinder->edge_count; i++) {
+            assert(cylinder->edges[i] >= 0 && cylinder->edges[i] < cylinder->vertex_count);
+        }
+    }
+    freeMeshSet(ms);
+
     // crossVector
     v_b = (Vector) { 1, 0, 0 };
     v_c = (Vector) { 0, 1, 0 };
@@ -597,7 +2182,11 @@ void test() {
 
 void init() {
     // Initialise important variables
+    inputWindow = initialiseInputWindow();
     view = initPolarVector(0.5, PI / 4, PI / 4);
+    picker = initialisePicker(WINDOW_WIDTH, WINDOW_HEIGHT);
+    sceneBuilder = initialiseSceneBuilder();
+    threadPool = initialiseThreadPool(SDL_GetCPUCount());
     for (int i = 0; i < MAX_ITEMS; i++) {
         SDL_Color c;
         c.r = 120 + 120 * (i & 0x1);
@@ -608,12 +2197,57 @@ void init() {
     }
 }
 
+// Creates the windows and renderers everything is shown with
+void openWindows() {
+    printf("Creating a window...\n");
+    window = SDL_CreateWindow(
+            TITLE,
+            SDL_WINDOWPOS_CENTERED,
+            SDL_WINDOWPOS_CENTERED, 
+            single ? INPUTWIN_WIDTH + WINDOW_WIDTH : WINDOW_WIDTH,
+            single && INPUTWIN_HEIGHT > WINDOW_HEIGHT ? INPUTWIN_HEIGHT : WINDOW_HEIGHT, 
+            0);
+
+    printf("Creating the renderer from the window...\n");
+    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    graphTexture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+            SDL_TEXTUREACCESS_TARGET, WINDOW_WIDTH, WINDOW_HEIGHT);
+    if (graphTexture == NULL && single) {
+        printf("Could not make the graph texture, using two windows\n");
+        single = false;
+        SDL_SetWindowSize(window, WINDOW_WIDTH, WINDOW_HEIGHT);
+    } else if (graphTexture == NULL) {
+        printf("Could not make the graph texture, drawing every frame whole\n");
+    }
+    
+    printf("Creating the input window...\n");
+    if (single) {
+        InputWindow_open(inputWindow, (SDL_Point) { 0, 0 }, renderer);
+    } else {
+        int wx, wy;
+        SDL_GetWindowPosition(window, &wx, &wy);
+        InputWindow_open(inputWindow, (SDL_Point) { wx, wy }, NULL);
+    }
+}
+
 // Frees memory
 int free_() {
     printf("Freeing memory...\n");
-    SDL_DestroyRenderer(renderer);
-    SDL_DestroyWindow(window);
+    if (rasteriser != NULL) freeRasteriser(rasteriser);
+    if (density != NULL) freeDensityMap(density);
+    if (graphTexture != NULL) SDL_DestroyTexture(graphTexture);
+    if (recorder != NULL) freeRecorder(recorder);
+    if (stream != NULL) freeStream(stream);
+    if (renderer != NULL) SDL_DestroyRenderer(renderer);
+    if (window != NULL) SDL_DestroyWindow(window);
     freePolarVector(view);
+    freePicker(picker);
+    if (meshes != NULL) freeMeshSet(meshes);
+    free(batch);
+    freeThreadPool(threadPool);
+    if (viewCache != NULL) freeViewCache(viewCache);
+    freeSceneBuilder(sceneBuilder);
     freeInputWindow(inputWindow);
 
     printf("Quitting SDL...\n");
@@ -630,38 +2264,117 @@ int main(int n, char const *args[]) {
     
     // Read in the command line arguments
     bool run_tests = false;
+    bool list_commands = false;
+    bool fit = false;
+    long accuracy_count = 0;
+    const char* load_file = NULL;
+    const char* render_file = NULL;
+    const char* export_file = NULL;
+    const char* stream_file = NULL;
+    int stream_keep = STREAM_DEFAULT_KEEP;
+    double render_scale = 1;
+    const char* record_file = NULL;
+    const char* replay_file = NULL;
+    const char* timings_file = NULL;
     for (int i = 1; i < n; i++) {
         if (strncmp(args[i], "-test", 5) == 0) run_tests = true;
+        if (strncmp(args[i], "-accuracy", 9) == 0 && i + 1 < n) accuracy_count = atol(args[++i]);
+        if (strncmp(args[i], "-raster", 7) == 0) rasterise = true;
+        if (strncmp(args[i], "-single", 7) == 0) single = true;
+        if (strncmp(args[i], "-views", 6) == 0) views = true;
+        if (strncmp(args[i], "-fit", 4) == 0) fit = true;
+        if (strncmp(args[i], "-density", 8) == 0) densityMode = true;
+        if (strncmp(args[i], "-load", 5) == 0 && i + 1 < n) load_file = args[++i];
+        if (strncmp(args[i], "-render", 7) == 0 && i + 1 < n) render_file = args[++i];
+        if (strncmp(args[i], "-export", 7) == 0 && i + 1 < n) export_file = args[++i];
+        if (strncmp(args[i], "-stream", 7) == 0 && i + 1 < n) stream_file = args[++i];
+        if (strncmp(args[i], "-keep", 5) == 0 && i + 1 < n) stream_keep = atoi(args[++i]);
+        if (strncmp(args[i], "-scale", 6) == 0 && i + 1 < n) render_scale = atof(args[++i]);
+        if (strncmp(args[i], "-record", 7) == 0 && i + 1 < n) record_file = args[++i];
+        if (strncmp(args[i], "-replay", 7) == 0 && i + 1 < n) replay_file = args[++i];
+        if (strncmp(args[i], "-timings", 8) == 0 && i + 1 < n) timings_file = args[++i];
+        if (strncmp(args[i], "-startup-profile", 16) == 0) startupProfile = true;
+        if (strncmp(args[i], "-commands", 9) == 0) list_commands = true;
+    }
+    if (render_scale <= 0) render_scale = 1;
+    if (list_commands) {
+        for (int i = 0; i < commandCount; i++) {
+            printf("    %s %s\n", commands[i].name, commands[i].arguments);
+        }
+        return 0;
     }
 
+    startupPhase(NULL);
     printf("Initialising SDL...\n");
-    SDL_Init(SDL_INIT_VIDEO);
-    TTF_Init();
-
-    printf("Creating a window...\n");
-    window = SDL_CreateWindow(
-            TITLE,
-            SDL_WINDOWPOS_CENTERED,
-            SDL_WINDOWPOS_CENTERED, 
-            WINDOW_WIDTH,
-            WINDOW_HEIGHT, 
-            0);
-
-    printf("Creating the renderer from the window...\n");
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
-    
-    printf("Creating the input window...\n");
-    int wx, wy;
-    SDL_GetWindowPosition(window, &wx, &wy);
-    inputWindow = initialiseInputWindow((SDL_Point) { wx, wy });
+    // Windows and fonts are only needed when something is shown
+    bool shown = render_file == NULL && export_file == NULL && !run_tests && accuracy_count == 0;
+    SDL_Init(shown ? SDL_INIT_VIDEO : 0);
+    if (shown) TTF_Init();
+    startupPhase("SDL");
 
     init();
-    if (run_tests) {
+    startupPhase("items");
+    if (load_file != NULL && !InputWindow_load(inputWindow, load_file)) {
+        printf("Could not load %s\n", load_file);
+    }
+    startupPhase("load");
+    if (fit) {
+        updateItems();
+        SceneBuilder_wait(sceneBuilder);
+        fitView();
+        startupPhase("fit");
+    }
+    if (shown) {
+        openWindows();
+        startupPhase("windows");
+    }
+    if (render_file != NULL) {
+        printf("Start up complete, rendering to %s...\n", render_file);
+        if (!renderToFile(render_file, render_scale)) {
+            printf("Could not save %s: %s\n", render_file, SDL_GetError());
+        }
+        startupPhase("render");
+    } else if (export_file != NULL) {
+        printf("Start up complete, exporting to %s...\n", export_file);
+        updateItems();
+        SceneBuilder_wait(sceneBuilder);
+        if (!exportToFile(export_file)) printf("Could not save %s\n", export_file);
+        startupPhase("export");
+    } else if (run_tests) {
         printf("Start up complete, running the tests...\n");      
         test();  
         printf("\n --- ALL TESTS PASSED --- \n\n");
+    } else if (accuracy_count > 0) {
+        printf("Start up complete, checking the fast paths...\n");
+        if (accuracy(accuracy_count)) {
+            printf("\n --- FAST PATHS MATCH --- \n\n");
+        } else {
+            printf("\n --- FAST PATHS DIFFER --- \n\n");
+            free_();
+            return 1;
+        }
+    } else if (replay_file != NULL) {
+        recorder = initialiseRecorder(replay_file, true,
+                SDL_GetWindowID(window), inputWindowID());
+        if (recorder == NULL) {
+            printf("Could not replay %s\n", replay_file);
+        } else {
+            printf("Start up complete, replaying %s...\n", replay_file);
+            replay();
+            if (!Recorder_report(recorder, timings_file)) {
+                printf("Could not save %s\n", timings_file);
+            }
+        }
     } else {
+        if (record_file != NULL) {
+            recorder = initialiseRecorder(record_file, false,
+                    SDL_GetWindowID(window), inputWindowID());
+            if (recorder == NULL) printf("Could not record to %s\n", record_file);
+        }
+        if (stream_file != NULL) {
+            stream = initialiseStream(stream_file, stream_keep);
+            if (stream == NULL) printf("Could not stream from %s\n", stream_file);
+        }
         printf("Start up complete, running the program...\n");
         run();
     }
@@ -15,12 +15,26 @@
 #define WINDOW_HEIGHT_MID (WINDOW_HEIGHT >> 1)
 // The length from the origin to the end of the axis
 #define AXIS_LENGTH 100
-// The size of the axis arrow
-#define AXIS_ARROW_SIZE (AXIS_LENGTH / 20)
+// The size of the axis arrow relative to the axis length
+#define AXIS_ARROW_SCALE 0.05
+// How far out the axis labels are relative to the axis length
+#define AXIS_LABEL_SCALE 1.2
 // How large the planes are rendered with respect to the axis length
 #define PLANE_SCALE 0.75
-// A number inversely proportional to how many lines appear inside a plane
-#define PLANE_LINES_SCALE 10.0
+// The spacing in pixels the grid lines inside a plane aim to be at least
+#define PLANE_GRID_PIXELS 16.0
+// The most grid lines drawn in each direction inside a plane
+#define PLANE_GRID_MAX_LINES 32
+// How much smaller the graph is in each of the split views than on its own
+#define VIEWS_SCALE 0.5
+// How many split views there are, top, free, front and side
+#define SPLIT_VIEWS 4
+// How many points of a big item are projected at once when drawing it
+#define PROJECT_BATCH 4096
+// How much of the smaller side of the window fitting the view fills
+#define FIT_MARGIN 0.9
+// The file the graph is exported to from the graph window
+#define EXPORT_FILE "graph.svg"
 // Defines how pixel movement of the mouse relates to rotation
 #define MOUSE_DRAG_FACTOR (1.0 / 200.0)
 
@@ -29,6 +43,27 @@
 #define UPDATES_PER_SECOND 50
 // Calculates the time inbetween updates in milliseconds
 #define UPDATE_DELTA_TIME  (1000 / UPDATES_PER_SECOND)
+// How many parts the points of big items are split into so a frame can
+// draw some of them and leave the rest for later frames, a power of two
+#define PROGRESSIVE_STRATA 64
+// How long in milliseconds a frame spends drawing the parts of big items
+#define PROGRESSIVE_BUDGET (UPDATE_DELTA_TIME / 2)
+
+// The largest difference -accuracy accepts between a fast path and the
+// reference maths, relative to the size of the input
+#define ACCURACY_TOLERANCE 1e-12
+// How many random points -accuracy projects from each random view
+#define ACCURACY_BATCH 1000
+
+// Defines the RGB values for the item under the mouse
+#define HOVER_R 255
+#define HOVER_G 255
+#define HOVER_B 120
+
+// Defines the RGB values for records read with -stream
+#define STREAM_R 120
+#define STREAM_G 200
+#define STREAM_B 255
 
 // Defines the RGB values for the background
 #define BG_R 40
@@ -1,5 +1,6 @@
 #include    <math.h>
 #include   <stdio.h>
+#include  <stdlib.h>
 #include  <string.h>
 #include <stdbool.h>
 #include   "maths.h"
@@ -57,16 +58,37 @@ void tuple2Multiply(Tuple2* t, double p) {
     t->b *= p;
 }
 
+// Interpolates between two tuples, putting a + t(b - a) in o
+void tuple3Lerp(Tuple3* o, Tuple3* a, Tuple3* b, double t) {
+    o->a = a->a + t * (b->a - a->a);
+    o->b = a->b + t * (b->b - a->b);
+    o->c = a->c + t * (b->c - a->c);
+}
+
 // Returns the length of a vector
 double norm(Vector* v) {
     return sqrt((v->x * v->x) + (v->y * v->y) + (v->z * v->z)); 
 }
 
+// Gets the smallest step of the form 1, 2 or 5 times a power of ten
+// that is at least the minimum
+double niceStep(double minimum) {
+    if (minimum <= 0) return 0;
+    double power = pow(10, floor(log10(minimum)));
+    // Guard against log10 rounding the power a decade too high
+    if (power > minimum) power /= 10;
+    if (power >= minimum) return power;
+    if (2 * power >= minimum) return 2 * power;
+    if (5 * power >= minimum) return 5 * power;
+    return 10 * power;
+}
+
 // Makes the plane that v is normal to
 void normalPlane(Plane* p, Vector* v) {
     p->x_coeff = v->x;
     p->y_coeff = v->y;
     p->z_coeff = v->z;
+    p->constant = 0;
 }
 
 // Makes v the normal to a plane
@@ -171,6 +193,28 @@ void getOrthonormals(Plane* p, Vector* u, Vector* w) {
     reduceToUnit(w);
 }
 
+// Gets the ends of the two lines of the head of an arrow v ending at the
+// tip, each going back along the arrow and out to one side by the scale
+// of its length, the sides being toward and away from the axis least in
+// line with the arrow
+void arrowHead(Point ends[2], Point* tip, Vector* v, double scale) {
+    double length = v->x * v->x + v->y * v->y + v->z * v->z;
+    ends[0] = ends[1] = *tip;
+    if (length == 0) return;
+    Vector axis = { 0, 0, 1 };
+    if (fabs(v->x) <= fabs(v->y) && fabs(v->x) <= fabs(v->z)) axis = (Vector) { 1, 0, 0 };
+    else if (fabs(v->y) <= fabs(v->z)) axis = (Vector) { 0, 1, 0 };
+    // The part of the axis square to the arrow
+    double along = (axis.x * v->x + axis.y * v->y + axis.z * v->z) / length;
+    Vector side = { axis.x - along * v->x, axis.y - along * v->y, axis.z - along * v->z };
+    double out = scale * sqrt(length / (side.x * side.x + side.y * side.y + side.z * side.z));
+    for (int k = 0; k < 2; k++, out = -out) {
+        ends[k].x += out * side.x - scale * v->x;
+        ends[k].y += out * side.y - scale * v->y;
+        ends[k].z += out * side.z - scale * v->z;
+    }
+}
+
 // Essentially solves for the coefficients such that av + bu + cw = p and puts them in o
 bool directionTo(Tuple3* o, Vector* v, Vector* u, Vector* w, Point* p) {
     double matrix[3][4];
@@ -225,3 +269,118 @@ bool directionTo(Tuple3* o, Vector* v, Vector* u, Vector* w, Point* p) {
     o->c = matrix[2][3];
     return true;
 }
+
+// Makes the basis of the view the same way the reference projection does
+void viewBasisFromPolar(ViewBasis* b, PolarVector* view) {
+    Plane viewPlane;
+    vectorFromPolar(&b->v, view);
+    normalPlane(&viewPlane, &b->v);
+    viewPlane.constant = view->r;
+    getOrthonormals(&viewPlane, &b->u, &b->w);
+    b->r = view->r;
+}
+
+// Projects a point to its x, y screen coordinates and depth, matching
+// directionTo in the basis but without solving a system for every point
+void viewBasisProject(Tuple3* t, ViewBasis* b, Point* p) {
+    Vector* v = &b->v;
+    double a = (p->x * v->x + p->y * v->y + p->z * v->z) / (v->x * v->x + v->y * v->y + v->z * v->z);
+    t->a = p->x * b->w.x + p->y * b->w.y + p->z * b->w.z;
+    t->b = -(p->x * b->u.x + p->y * b->u.y + p->z * b->u.z);
+    t->c = a * b->r;
+}
+
+void initialiseSystems3(Systems3* s) {
+    s->count = 0;
+    s->capacity = 0;
+    for (int i = 0; i < 9; i++) s->m[i] = NULL;
+    for (int i = 0; i < 3; i++) s->r[i] = NULL;
+    for (int i = 0; i < 3; i++) s->x[i] = NULL;
+    s->singular = NULL;
+}
+
+// Adds the system with the coefficients m, row by row, and right hand
+// side r, returning its index
+int Systems3_add(Systems3* s, double m[9], double r[3]) {
+    if (s->count == s->capacity) {
+        s->capacity = s->capacity == 0 ? 64 : s->capacity * 2;
+        for (int i = 0; i < 9; i++) s->m[i] = realloc(s->m[i], sizeof(double) * s->capacity);
+        for (int i = 0; i < 3; i++) s->r[i] = realloc(s->r[i], sizeof(double) * s->capacity);
+        for (int i = 0; i < 3; i++) s->x[i] = realloc(s->x[i], sizeof(double) * s->capacity);
+        s->singular = realloc(s->singular, sizeof(bool) * s->capacity);
+    }
+    for (int i = 0; i < 9; i++) s->m[i][s->count] = m[i];
+    for (int i = 0; i < 3; i++) s->r[i][s->count] = r[i];
+    return s->count++;
+}
+
+// Solves every system by Cramer's rule, without branches so the loop
+// can be vectorised
+void Systems3_solve(Systems3* s) {
+    const double* restrict a = s->m[0];
+    const double* restrict b = s->m[1];
+    const double* restrict c = s->m[2];
+    const double* restrict d = s->m[3];
+    const double* restrict e = s->m[4];
+    const double* restrict f = s->m[5];
+    const double* restrict g = s->m[6];
+    const double* restrict h = s->m[7];
+    const double* restrict k = s->m[8];
+    const double* restrict r0 = s->r[0];
+    const double* restrict r1 = s->r[1];
+    const double* restrict r2 = s->r[2];
+    double* restrict x0 = s->x[0];
+    double* restrict x1 = s->x[1];
+    double* restrict x2 = s->x[2];
+    bool* restrict singular = s->singular;
+    for (int i = 0; i < s->count; i++) {
+        // The first column of the adjugate
+        double c0 = e[i] * k[i] - f[i] * h[i];
+        double c1 = f[i] * g[i] - d[i] * k[i];
+        double c2 = d[i] * h[i] - e[i] * g[i];
+        double det = a[i] * c0 + b[i] * c1 + c[i] * c2;
+        // The determinant is at most the product of the row lengths
+        double n0 = a[i] * a[i] + b[i] * b[i] + c[i] * c[i];
+        double n1 = d[i] * d[i] + e[i] * e[i] + f[i] * f[i];
+        double n2 = g[i] * g[i] + h[i] * h[i] + k[i] * k[i];
+        bool degenerate = det * det <= SOLVE_EPSILON * SOLVE_EPSILON * n0 * n1 * n2;
+        double inverse = degenerate ? 0 : 1 / (degenerate ? 1 : det);
+        x0[i] = (c0 * r0[i] + (c[i] * h[i] - b[i] * k[i]) * r1[i]
+                + (b[i] * f[i] - c[i] * e[i]) * r2[i]) * inverse;
+        x1[i] = (c1 * r0[i] + (a[i] * k[i] - c[i] * g[i]) * r1[i]
+                + (c[i] * d[i] - a[i] * f[i]) * r2[i]) * inverse;
+        x2[i] = (c2 * r0[i] + (b[i] * g[i] - a[i] * h[i]) * r1[i]
+                + (a[i] * e[i] - b[i] * d[i]) * r2[i]) * inverse;
+        singular[i] = degenerate;
+    }
+}
+
+void freeSystems3(Systems3* s) {
+    for (int i = 0; i < 9; i++) free(s->m[i]);
+    for (int i = 0; i < 3; i++) free(s->r[i]);
+    for (int i = 0; i < 3; i++) free(s->x[i]);
+    free(s->singular);
+}
+
+// Clips the line from (x, y) along (dx, dy) to the rectangle, narrowing
+// the range [t0, t1] along it, returning false if none of it is left
+bool clipLine(double x, double y, double dx, double dy,
+        double min_x, double min_y, double max_x, double max_y, double* t0, double* t1) {
+    double p[4] = { -dx, dx, -dy, dy };
+    double q[4] = { x - min_x, max_x - x, y - min_y, max_y - y };
+    for (int i = 0; i < 4; i++) {
+        if (p[i] == 0) {
+            if (q[i] < 0) return false;
+            continue;
+        }
+        double t = q[i] / p[i];
+        if (p[i] < 0) {
+            if (t > *t1) return false;
+            if (t > *t0) *t0 = t;
+        } else {
+            if (t < *t0) return false;
+            if (t < *t1) *t1 = t;
+        }
+    }
+    return true;
+}
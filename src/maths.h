@@ -5,6 +5,9 @@
 
 // Defines PI
 #define PI acos(-1.0)
+// How small a system's determinant can be, relative to the lengths of
+// its rows, before it is treated as having no single solution
+#define SOLVE_EPSILON 1e-9
 
 //
 //      STRUCTS
@@ -58,6 +61,28 @@ typedef struct Plane_ {
     double constant;
 } Plane;
 
+// The view vector and the orthonormals of the plane normal to it, which
+// are at right angles to each other so a point's coefficients in them
+// are just dot products
+typedef struct ViewBasis_ {
+    Vector v;
+    Vector u;
+    Vector w;
+    double r;
+} ViewBasis;
+
+// A batch of 3x3 systems mx = r kept as one array per coefficient, row
+// by row, so they can all be solved in one loop
+typedef struct Systems3_ {
+    int count;
+    int capacity;
+    double* m[9];
+    double* r[3];
+    double* x[3];
+    // Set for systems with no single solution, which have x set to 0
+    bool* singular;
+} Systems3;
+
 //
 //      FUNCTIONS
 //
@@ -65,8 +90,10 @@ typedef struct Plane_ {
 void readEquation(unsigned long size, char* eq);
 
 double norm(Vector* v);
+double niceStep(double minimum);
 
 void tuple2Multiply(Tuple2* t, double p);
+void tuple3Lerp(Tuple3* o, Tuple3* a, Tuple3* b, double t);
 void vectorSum(Vector* o, Vector* v, Vector* u);
 void vectorMultiply(Vector* v, double p);
 
@@ -85,9 +112,21 @@ void zeroPlane(Plane* p);
 void zeroVector(Vector* v);
 
 void getOrthonormals(Plane* p, Vector* u, Vector* w);
+void arrowHead(Point ends[2], Point* tip, Vector* v, double scale);
 
 bool directionTo(Tuple3* o, Vector* v, Vector* u, Vector* w, Point* p);
 
+void viewBasisFromPolar(ViewBasis* b, PolarVector* view);
+void viewBasisProject(Tuple3* t, ViewBasis* b, Point* p);
+
+void initialiseSystems3(Systems3* s);
+int Systems3_add(Systems3* s, double m[9], double r[3]);
+void Systems3_solve(Systems3* s);
+void freeSystems3(Systems3* s);
+
+bool clipLine(double x, double y, double dx, double dy,
+        double min_x, double min_y, double max_x, double max_y, double* t0, double* t1);
+
 void printPlane(Plane* p);
 void printVector(Vector* v);
 void printPolarVector(PolarVector* pv);
@@ -0,0 +1,94 @@
+#include    <math.h>
+#include  <stdlib.h>
+#include <stdbool.h>
+#include   "maths.h"
+#include    "mesh.h"
+
+// Makes room for the vertices and edges
+void allocateMesh(Mesh* m, int vertices, int edges) {
+    m->vertex_count = vertices;
+    m->vertices = malloc(sizeof(Point) * vertices);
+    m->edge_count = 0;
+    m->edges = malloc(sizeof(int) * 2 * edges);
+}
+
+void addEdge(Mesh* m, int a, int b) {
+    m->edges[2 * m->edge_count] = a;
+    m->edges[2 * m->edge_count + 1] = b;
+    m->edge_count++;
+}
+
+// A sphere of circles of latitude and every other meridian, with the
+// segments around each circle
+void makeSphere(Mesh* m, int segments) {
+    int rings = segments / 2;
+    allocateMesh(m, (rings + 1) * segments, (rings - 1) * segments + (segments / 2) * rings);
+    for (int k = 0; k <= rings; k++) {
+        double theta = PI * k / rings;
+        for (int j = 0; j < segments; j++) {
+            double phi = 2 * PI * j / segments;
+            m->vertices[k * segments + j] = (Point) {
+                sin(theta) * cos(phi), sin(theta) * sin(phi), cos(theta) };
+        }
+    }
+    // The poles are points so have no circles
+    for (int k = 1; k < rings; k++) {
+        for (int j = 0; j < segments; j++) {
+            addEdge(m, k * segments + j, k * segments + (j + 1) % segments);
+        }
+    }
+    for (int j = 0; j < segments; j += 2) {
+        for (int k = 0; k < rings; k++) addEdge(m, k * segments + j, (k + 1) * segments + j);
+    }
+}
+
+// A cylinder of its two end circles and lines between them at every
+// other vertex
+void makeCylinder(Mesh* m, int segments) {
+    allocateMesh(m, 2 * segments, 2 * segments + segments / 2);
+    for (int j = 0; j < segments; j++) {
+        double phi = 2 * PI * j / segments;
+        m->vertices[j] = (Point) { cos(phi), sin(phi), 0 };
+        m->vertices[segments + j] = (Point) { cos(phi), sin(phi), 1 };
+    }
+    for (int j = 0; j < segments; j++) {
+        addEdge(m, j, (j + 1) % segments);
+        addEdge(m, segments + j, segments + (j + 1) % segments);
+    }
+    for (int j = 0; j < segments; j += 2) addEdge(m, j, segments + j);
+}
+
+MeshSet* initialiseMeshSet() {
+    MeshSet* set = malloc(sizeof(MeshSet));
+    int most = 0;
+    for (int l = 0; l < MESH_LEVELS; l++) {
+        int segments = MESH_MIN_SEGMENTS << l;
+        makeSphere(&set->meshes[MESH_SPHERE][l], segments);
+        makeCylinder(&set->meshes[MESH_CYLINDER][l], segments);
+        for (int s = 0; s < MESH_SHAPES; s++) {
+            if (set->meshes[s][l].vertex_count > most) most = set->meshes[s][l].vertex_count;
+        }
+    }
+    set->projected = malloc(sizeof(Tuple3) * most);
+    return set;
+}
+
+// Gets the level of detail for a shape whose radius is the given number
+// of pixels on screen
+int meshLevel(double pixels) {
+    double segments = 2 * PI * pixels / MESH_SEGMENT_PIXELS;
+    int level = 0;
+    while (level < MESH_LEVELS - 1 && (MESH_MIN_SEGMENTS << level) < segments) level++;
+    return level;
+}
+
+void freeMeshSet(MeshSet* set) {
+    for (int s = 0; s < MESH_SHAPES; s++) {
+        for (int l = 0; l < MESH_LEVELS; l++) {
+            free(set->meshes[s][l].vertices);
+            free(set->meshes[s][l].edges);
+        }
+    }
+    free(set->projected);
+    free(set);
+}
@@ -0,0 +1,40 @@
+#ifndef MESH_H_
+#define MESH_H_
+
+// How many levels of detail each shape has, each doubling the segments
+// around the one before
+#define MESH_LEVELS 4
+// The segments around the least detailed meshes
+#define MESH_MIN_SEGMENTS 8
+// How long in pixels the segments of a shape aim to be at most on screen
+#define MESH_SEGMENT_PIXELS 12.0
+
+typedef enum MeshShape_ {
+    // A sphere of radius 1 around the origin
+    MESH_SPHERE,
+    // A cylinder of radius 1 around the z axis from z = 0 to z = 1
+    MESH_CYLINDER,
+    MESH_SHAPES
+} MeshShape;
+
+// A wireframe made of the lines between pairs of vertices
+typedef struct Mesh_ {
+    int vertex_count;
+    Point* vertices;
+    int edge_count;
+    int* edges;
+} Mesh;
+
+// Every level of every shape, made once and drawn for every item of that
+// shape by moving and stretching it
+typedef struct MeshSet_ {
+    Mesh meshes[MESH_SHAPES][MESH_LEVELS];
+    // Space for the projected vertices of the biggest mesh
+    Tuple3* projected;
+} MeshSet;
+
+MeshSet* initialiseMeshSet();
+int meshLevel(double pixels);
+void freeMeshSet(MeshSet* set);
+
+#endif
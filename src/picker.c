@@ -0,0 +1,142 @@
+#include  <stdlib.h>
+#include    <math.h>
+#include <stdbool.h>
+#include   "maths.h"
+#include  "picker.h"
+
+Picker* initialisePicker(int width, int height) {
+    Picker* p = malloc(sizeof(Picker));
+    p->width = width;
+    p->height = height;
+    p->cells_x = (width + PICKER_CELL_SIZE - 1) / PICKER_CELL_SIZE;
+    p->cells_y = (height + PICKER_CELL_SIZE - 1) / PICKER_CELL_SIZE;
+    p->segment_count = 0;
+    p->segment_capacity = 1024;
+    p->segments = malloc(sizeof(PickerSegment) * p->segment_capacity);
+    p->cell_start = calloc(p->cells_x * p->cells_y + 1, sizeof(int));
+    p->cell_capacity = 1024;
+    p->cell_items = malloc(sizeof(int) * p->cell_capacity);
+    return p;
+}
+
+// Forgets every segment, ready for them to be drawn again
+void Picker_clear(Picker* p) {
+    p->segment_count = 0;
+    for (int i = 0; i <= p->cells_x * p->cells_y; i++) p->cell_start[i] = 0;
+}
+
+// Adds a segment between two window coordinates for the item
+void Picker_addSegment(Picker* p, Tuple3* a, Tuple3* b, int item) {
+    if (p->segment_count == p->segment_capacity) {
+        p->segment_capacity <<= 1;
+        p->segments = realloc(p->segments, sizeof(PickerSegment) * p->segment_capacity);
+    }
+    p->segments[p->segment_count++] = (PickerSegment) { a->a, a->b, a->c, b->a, b->b, b->c, item };
+}
+
+// Adds the segment to every cell it passes through, sampling it every
+// half a cell so each point on it is within half a cell of a cell it
+// was added to, or only counts the cells if there is no cursor
+void walkSegment(Picker* p, PickerSegment* s, int index, int* cursor) {
+    double x = s->x0, y = s->y0;
+    double dx = s->x1 - x, dy = s->y1 - y;
+    if (!isfinite(dx) || !isfinite(dy)) return;
+    // Clip the segment to the window
+    double t0 = 0, t1 = 1;
+    if (!clipLine(x, y, dx, dy, 0, 0, p->width - 1, p->height - 1, &t0, &t1)) return;
+    int steps = ceil(sqrt(dx * dx + dy * dy) * (t1 - t0) / (PICKER_CELL_SIZE / 2.0));
+    int last = -1;
+    for (int i = 0; i <= steps; i++) {
+        double t = steps == 0 ? t0 : t0 + (t1 - t0) * i / steps;
+        int cx = (x + t * dx) / PICKER_CELL_SIZE;
+        int cy = (y + t * dy) / PICKER_CELL_SIZE;
+        if (cx < 0 || cx >= p->cells_x || cy < 0 || cy >= p->cells_y) continue;
+        int cell = cy * p->cells_x + cx;
+        if (cell == last) continue;
+        last = cell;
+        if (cursor == NULL) {
+            p->cell_start[cell + 1]++;
+        } else {
+            p->cell_items[cursor[cell]++] = index;
+        }
+    }
+}
+
+// Sorts the segments into the cells they pass through, always from
+// scratch, segments are only added by redrawing the whole graph and any
+// change of view moves every one of them, so there are no cells left
+// as they were to keep, and the sort is linear in the segments
+void Picker_build(Picker* p) {
+    int cells = p->cells_x * p->cells_y;
+    for (int i = 0; i <= cells; i++) p->cell_start[i] = 0;
+    // Count the segments in each cell
+    for (int i = 0; i < p->segment_count; i++) walkSegment(p, &p->segments[i], i, NULL);
+    for (int i = 0; i < cells; i++) p->cell_start[i + 1] += p->cell_start[i];
+    if (p->cell_start[cells] > p->cell_capacity) {
+        while (p->cell_start[cells] > p->cell_capacity) p->cell_capacity <<= 1;
+        p->cell_items = realloc(p->cell_items, sizeof(int) * p->cell_capacity);
+    }
+    // Fill each cell's list, using the start of the list as its cursor
+    for (int i = 0; i < p->segment_count; i++) walkSegment(p, &p->segments[i], i, p->cell_start);
+    for (int i = cells; i > 0; i--) p->cell_start[i] = p->cell_start[i - 1];
+    p->cell_start[0] = 0;
+}
+
+// Gets the point of a segment closest to (x, y) as how far along it it
+// is, returning the distance to it
+double segmentDistance(PickerSegment* s, double x, double y, double* t) {
+    double dx = s->x1 - s->x0, dy = s->y1 - s->y0;
+    double length = dx * dx + dy * dy;
+    *t = length == 0 ? 0 : ((x - s->x0) * dx + (y - s->y0) * dy) / length;
+    if (*t < 0) *t = 0;
+    if (*t > 1) *t = 1;
+    double ex = s->x0 + *t * dx - x, ey = s->y0 + *t * dy - y;
+    return sqrt(ex * ex + ey * ey);
+}
+
+// Gets the item of the segment within PICKER_RADIUS of (x, y) that is
+// closest to the viewer where it passes (x, y), like the rasteriser's
+// depth test, then the nearest to (x, y), with later segments winning
+// ties as they are on top, or -1 if there is none, segments hidden
+// behind the depth buffer, if there is one, are skipped
+int Picker_pick(Picker* p, double x, double y, float* depth) {
+    double reach = PICKER_RADIUS + PICKER_CELL_SIZE / 2.0;
+    int cx0 = fmax(0, floor((x - reach) / PICKER_CELL_SIZE));
+    int cy0 = fmax(0, floor((y - reach) / PICKER_CELL_SIZE));
+    int cx1 = fmin(p->cells_x - 1, floor((x + reach) / PICKER_CELL_SIZE));
+    int cy1 = fmin(p->cells_y - 1, floor((y + reach) / PICKER_CELL_SIZE));
+    int best = -1;
+    double best_distance = PICKER_RADIUS, best_z = -INFINITY;
+    for (int cy = cy0; cy <= cy1; cy++) {
+        for (int cx = cx0; cx <= cx1; cx++) {
+            int cell = cy * p->cells_x + cx;
+            for (int i = p->cell_start[cell]; i < p->cell_start[cell + 1]; i++) {
+                int index = p->cell_items[i];
+                PickerSegment* s = &p->segments[index];
+                double t;
+                double d = segmentDistance(s, x, y, &t);
+                if (d > PICKER_RADIUS) continue;
+                double z = s->z0 + t * (s->z1 - s->z0);
+                if (depth != NULL) {
+                    int px = s->x0 + t * (s->x1 - s->x0);
+                    int py = s->y0 + t * (s->y1 - s->y0);
+                    if (px >= 0 && px < p->width && py >= 0 && py < p->height
+                            && z < depth[py * p->width + px] - PICKER_DEPTH_BIAS) continue;
+                }
+                if (z > best_z || (z == best_z && (d < best_distance || (d == best_distance && index > best)))) {
+                    best_z = z;
+                    best_distance = d;
+                    best = index;
+                }
+            }
+        }
+    }
+    return best == -1 ? -1 : p->segments[best].item;
+}
+
+void freePicker(Picker* p) {
+    free(p->cell_items);
+    free(p->cell_start);
+    free(p->segments);
+    free(p);
+}
@@ -0,0 +1,49 @@
+#ifndef PICKER_H_
+#define PICKER_H_
+
+// The width and height in pixels of the cells segments are sorted into
+#define PICKER_CELL_SIZE 16
+// How close in pixels the mouse has to be to a segment to pick it
+#define PICKER_RADIUS 6.0
+// How far behind a depth buffer a segment can be and still be picked,
+// the same leeway the rasteriser gives lines
+#define PICKER_DEPTH_BIAS 0.5
+
+// A projected segment with the depths of its ends, where greater is
+// closer, and the item it was drawn for
+typedef struct PickerSegment_ {
+    float x0;
+    float y0;
+    float z0;
+    float x1;
+    float y1;
+    float z1;
+    int item;
+} PickerSegment;
+
+// A uniform grid over the window of the segments drawn in it
+typedef struct Picker_ {
+
+    int width;
+    int height;
+    int cells_x;
+    int cells_y;
+
+    int segment_count;
+    int segment_capacity;
+    PickerSegment* segments;
+
+    int* cell_start;
+    int* cell_items;
+    int cell_capacity;
+
+} Picker;
+
+Picker* initialisePicker(int width, int height);
+void Picker_clear(Picker* p);
+void Picker_addSegment(Picker* p, Tuple3* a, Tuple3* b, int item);
+void Picker_build(Picker* p);
+int Picker_pick(Picker* p, double x, double y, float* depth);
+void freePicker(Picker* p);
+
+#endif
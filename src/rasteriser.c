@@ -0,0 +1,290 @@
+#include        <SDL.h>
+#include       <math.h>
+#include    <stdbool.h>
+#include      "maths.h"
+#include "threadPool.h"
+#include "rasteriser.h"
+
+// Packs a colour into a ARGB8888 pixel
+Uint32 packColor(SDL_Color c) {
+    return (0xFFu << 24) | ((Uint32) c.r << 16) | ((Uint32) c.g << 8) | (Uint32) c.b;
+}
+
+// Mixes the colour over the background with the given alpha out of 255
+Uint32 blendColor(SDL_Color c, SDL_Color bg, int alpha) {
+    SDL_Color o;
+    o.r = bg.r + (((int) c.r - bg.r) * alpha) / 255;
+    o.g = bg.g + (((int) c.g - bg.g) * alpha) / 255;
+    o.b = bg.b + (((int) c.b - bg.b) * alpha) / 255;
+    return packColor(o);
+}
+
+// Creates a rasteriser with a framebuffer of the given size, window
+// coordinates are multiplied by the scale to get framebuffer coordinates
+// and the renderer can be NULL if the frame is never drawn to a window
+Rasteriser* initialiseRasteriser(SDL_Renderer* renderer, int width, int height, double scale, ThreadPool* pool) {
+    Rasteriser* r = malloc(sizeof(Rasteriser));
+    r->width = width;
+    r->height = height;
+    r->scale = scale;
+    r->pixels = malloc(sizeof(Uint32) * width * height);
+    r->depth = malloc(sizeof(float) * width * height);
+    r->texture = NULL;
+    if (renderer != NULL) {
+        r->texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                SDL_TEXTUREACCESS_STREAMING, width, height);
+    }
+    r->color = (SDL_Color) { 255, 255, 255, 255 };
+    r->background = (SDL_Color) { 0, 0, 0, 255 };
+
+    r->clearing = true;
+    r->primitive_count = 0;
+    r->primitive_capacity = 1024;
+    r->primitives = malloc(sizeof(RasteriserPrimitive) * r->primitive_capacity);
+
+    r->tiles_x = (width + RASTERISER_TILE_SIZE - 1) / RASTERISER_TILE_SIZE;
+    r->tiles_y = (height + RASTERISER_TILE_SIZE - 1) / RASTERISER_TILE_SIZE;
+    r->bin_start = malloc(sizeof(int) * (r->tiles_x * r->tiles_y + 1));
+    r->bin_capacity = 1024;
+    r->bin_items = malloc(sizeof(int) * r->bin_capacity);
+
+    r->pool = pool;
+    return r;
+}
+
+// Starts a new frame, the framebuffer itself is cleared tile by tile
+// when the frame is flushed
+void Rasteriser_clear(Rasteriser* r, SDL_Color background) {
+    r->background = background;
+    r->clearing = true;
+    r->primitive_count = 0;
+}
+
+void Rasteriser_setColor(Rasteriser* r, SDL_Color c) {
+    r->color = c;
+}
+
+// Gets space for another primitive at the end of the frame
+RasteriserPrimitive* pushPrimitive(Rasteriser* r) {
+    if (r->primitive_count == r->primitive_capacity) {
+        r->primitive_capacity <<= 1;
+        r->primitives = realloc(r->primitives, sizeof(RasteriserPrimitive) * r->primitive_capacity);
+    }
+    return &r->primitives[r->primitive_count++];
+}
+
+// Puts a window coordinate into a primitive as a framebuffer coordinate
+void setVertex(Rasteriser* r, RasteriserPrimitive* p, int i, Tuple3* t) {
+    p->x[i] = t->a * r->scale;
+    p->y[i] = t->b * r->scale;
+    p->z[i] = t->c;
+}
+
+// Adds a line between two window coordinates, each with a depth where
+// greater is closer, which hides behind what is drawn in front of it
+void Rasteriser_drawLine(Rasteriser* r, Tuple3* a, Tuple3* b) {
+    RasteriserPrimitive* p = pushPrimitive(r);
+    p->type = RASTERISER_LINE;
+    p->color = packColor(r->color);
+    setVertex(r, p, 0, a);
+    setVertex(r, p, 1, b);
+}
+
+// Adds a triangle of window coordinates filled with a faint version of
+// the current colour
+void Rasteriser_fillTriangle(Rasteriser* r, Tuple3* a, Tuple3* b, Tuple3* c) {
+    RasteriserPrimitive* p = pushPrimitive(r);
+    p->type = RASTERISER_TRIANGLE;
+    p->color = blendColor(r->color, r->background, RASTERISER_FILL_ALPHA);
+    setVertex(r, p, 0, a);
+    setVertex(r, p, 1, b);
+    setVertex(r, p, 2, c);
+}
+
+// Draws the part of a line inside the tile [x0, x1) by [y0, y1), the
+// pixels stepped through are the same whichever tile is drawing
+void rasteriseLine(Rasteriser* r, RasteriserPrimitive* p, int x0, int y0, int x1, int y1) {
+    double x = p->x[0], y = p->y[0], z = p->z[0];
+    double dx = p->x[1] - x, dy = p->y[1] - y, dz = p->z[1] - z;
+    if (!isfinite(dx) || !isfinite(dy) || !isfinite(dz)) return;
+    // Clip the line to the framebuffer
+    double t0 = 0, t1 = 1;
+    if (!clipLine(x, y, dx, dy, 0, 0, r->width - 1, r->height - 1, &t0, &t1)) return;
+    // Step along the longer axis a pixel at a time
+    int steps = ceil(fmax(fabs(dx), fabs(dy)) * (t1 - t0));
+    double dt = steps == 0 ? 0 : (t1 - t0) / steps;
+    // Only step through the part of the line near the tile
+    double a = t0, b = t1;
+    if (!clipLine(x, y, dx, dy, x0 - 1, y0 - 1, x1, y1, &a, &b)) return;
+    int s0 = 0, s1 = steps;
+    if (dt > 0) {
+        s0 = fmax(0, floor((a - t0) / dt) - 1);
+        s1 = fmin(steps, ceil((b - t0) / dt) + 1);
+    }
+    for (int s = s0; s <= s1; s++) {
+        double t = t0 + s * dt;
+        int px = x + t * dx + 0.5;
+        int py = y + t * dy + 0.5;
+        if (px < x0 || px >= x1 || py < y0 || py >= y1) continue;
+        float pz = z + t * dz;
+        int i = py * r->width + px;
+        if (pz < r->depth[i] - RASTERISER_DEPTH_BIAS) continue;
+        r->pixels[i] = p->color;
+        if (pz > r->depth[i]) r->depth[i] = pz;
+    }
+}
+
+// Fills the part of a triangle inside the tile [x0, x1) by [y0, y1),
+// interpolating the depth across it
+void rasteriseTriangle(Rasteriser* r, RasteriserPrimitive* p, int x0, int y0, int x1, int y1) {
+    double ax = p->x[0], ay = p->y[0], az = p->z[0];
+    double bx = p->x[1], by = p->y[1], bz = p->z[1];
+    double cx = p->x[2], cy = p->y[2], cz = p->z[2];
+    double area = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+    if (area == 0 || !isfinite(area)) return;
+    // Get the bounding box of the triangle within the tile
+    int min_x = fmax(x0, floor(fmin(ax, fmin(bx, cx))));
+    int min_y = fmax(y0, floor(fmin(ay, fmin(by, cy))));
+    int max_x = fmin(x1 - 1, ceil(fmax(ax, fmax(bx, cx))));
+    int max_y = fmin(y1 - 1, ceil(fmax(ay, fmax(by, cy))));
+    for (int y = min_y; y <= max_y; y++) {
+        double py = y + 0.5;
+        for (int x = min_x; x <= max_x; x++) {
+            double px = x + 0.5;
+            // Get the barycentric weights of the pixel centre
+            double w_a = ((bx - px) * (cy - py) - (by - py) * (cx - px)) / area;
+            double w_b = ((cx - px) * (ay - py) - (cy - py) * (ax - px)) / area;
+            double w_c = 1 - w_a - w_b;
+            if (w_a < 0 || w_b < 0 || w_c < 0) continue;
+            float z = w_a * az + w_b * bz + w_c * cz;
+            int i = y * r->width + x;
+            if (z <= r->depth[i]) continue;
+            r->pixels[i] = p->color;
+            r->depth[i] = z;
+        }
+    }
+}
+
+// Gets the range of tiles a primitive's bounding box covers, returning
+// false if it is entirely outside the framebuffer
+bool primitiveTiles(Rasteriser* r, RasteriserPrimitive* p, int* tx0, int* ty0, int* tx1, int* ty1) {
+    int n = p->type == RASTERISER_LINE ? 2 : 3;
+    double min_x = p->x[0], max_x = p->x[0];
+    double min_y = p->y[0], max_y = p->y[0];
+    for (int i = 1; i < n; i++) {
+        min_x = fmin(min_x, p->x[i]);
+        max_x = fmax(max_x, p->x[i]);
+        min_y = fmin(min_y, p->y[i]);
+        max_y = fmax(max_y, p->y[i]);
+    }
+    if (!isfinite(min_x) || !isfinite(max_x) || !isfinite(min_y) || !isfinite(max_y)) return false;
+    // Lines round to the nearest pixel so can land a pixel further out
+    min_x = fmax(0, floor(min_x) - 1);
+    min_y = fmax(0, floor(min_y) - 1);
+    max_x = fmin(r->width - 1, ceil(max_x) + 1);
+    max_y = fmin(r->height - 1, ceil(max_y) + 1);
+    if (min_x > max_x || min_y > max_y) return false;
+    *tx0 = (int) min_x / RASTERISER_TILE_SIZE;
+    *ty0 = (int) min_y / RASTERISER_TILE_SIZE;
+    *tx1 = (int) max_x / RASTERISER_TILE_SIZE;
+    *ty1 = (int) max_y / RASTERISER_TILE_SIZE;
+    return true;
+}
+
+// Sorts the primitives into lists for each tile they may touch, keeping
+// the order they were drawn in
+void binPrimitives(Rasteriser* r) {
+    int tiles = r->tiles_x * r->tiles_y;
+    int tx0, ty0, tx1, ty1;
+    // Count how many primitives touch each tile
+    for (int i = 0; i <= tiles; i++) r->bin_start[i] = 0;
+    for (int i = 0; i < r->primitive_count; i++) {
+        if (!primitiveTiles(r, &r->primitives[i], &tx0, &ty0, &tx1, &ty1)) continue;
+        for (int ty = ty0; ty <= ty1; ty++) {
+            for (int tx = tx0; tx <= tx1; tx++) r->bin_start[ty * r->tiles_x + tx + 1]++;
+        }
+    }
+    // Turn the counts into where each tile's list starts
+    for (int i = 0; i < tiles; i++) r->bin_start[i + 1] += r->bin_start[i];
+    if (r->bin_start[tiles] > r->bin_capacity) {
+        while (r->bin_start[tiles] > r->bin_capacity) r->bin_capacity <<= 1;
+        r->bin_items = realloc(r->bin_items, sizeof(int) * r->bin_capacity);
+    }
+    // Fill the lists, using the start of each list as its cursor
+    for (int i = 0; i < r->primitive_count; i++) {
+        if (!primitiveTiles(r, &r->primitives[i], &tx0, &ty0, &tx1, &ty1)) continue;
+        for (int ty = ty0; ty <= ty1; ty++) {
+            for (int tx = tx0; tx <= tx1; tx++) {
+                r->bin_items[r->bin_start[ty * r->tiles_x + tx]++] = i;
+            }
+        }
+    }
+    // Every cursor has moved to the end of its list, move them back
+    for (int i = tiles; i > 0; i--) r->bin_start[i] = r->bin_start[i - 1];
+    r->bin_start[0] = 0;
+}
+
+// Draws one tile, clearing it first if the frame has just started, tiles
+// never overlap so the workers can write to the framebuffer without
+// locking
+void rasteriseTile(void* data, int tile, int worker) {
+    Rasteriser* r = data;
+    int x0 = (tile % r->tiles_x) * RASTERISER_TILE_SIZE;
+    int y0 = (tile / r->tiles_x) * RASTERISER_TILE_SIZE;
+    int x1 = x0 + RASTERISER_TILE_SIZE;
+    int y1 = y0 + RASTERISER_TILE_SIZE;
+    if (x1 > r->width) x1 = r->width;
+    if (y1 > r->height) y1 = r->height;
+    Uint32 bg = packColor(r->background);
+    for (int y = y0; r->clearing && y < y1; y++) {
+        for (int x = x0; x < x1; x++) {
+            r->pixels[y * r->width + x] = bg;
+            r->depth[y * r->width + x] = -INFINITY;
+        }
+    }
+    for (int i = r->bin_start[tile]; i < r->bin_start[tile + 1]; i++) {
+        RasteriserPrimitive* p = &r->primitives[r->bin_items[i]];
+        if (p->type == RASTERISER_LINE) {
+            rasteriseLine(r, p, x0, y0, x1, y1);
+        } else {
+            rasteriseTriangle(r, p, x0, y0, x1, y1);
+        }
+    }
+}
+
+// Rasterises everything drawn since the last flush into the framebuffer,
+// so a frame can be flushed in parts each only costing what it added
+void Rasteriser_flush(Rasteriser* r) {
+    if (r->primitive_count == 0 && !r->clearing) return;
+    binPrimitives(r);
+    ThreadPool_run(r->pool, r->tiles_x * r->tiles_y, rasteriseTile, r);
+    r->clearing = false;
+    r->primitive_count = 0;
+}
+
+// Saves the framebuffer as a bitmap, returning whether it succeeded
+bool Rasteriser_save(Rasteriser* r, const char* file) {
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormatFrom(r->pixels, r->width, r->height,
+            32, r->width * sizeof(Uint32), SDL_PIXELFORMAT_ARGB8888);
+    if (surface == NULL) return false;
+    bool saved = SDL_SaveBMP(surface, file) == 0;
+    SDL_FreeSurface(surface);
+    return saved;
+}
+
+// Rasterises the frame, uploads it and copies it onto the renderer
+void drawRasteriser(Rasteriser* r, SDL_Renderer* renderer) {
+    Rasteriser_flush(r);
+    SDL_UpdateTexture(r->texture, NULL, r->pixels, r->width * sizeof(Uint32));
+    SDL_RenderCopy(renderer, r->texture, NULL, NULL);
+}
+
+void freeRasteriser(Rasteriser* r) {
+    if (r->texture != NULL) SDL_DestroyTexture(r->texture);
+    free(r->bin_items);
+    free(r->bin_start);
+    free(r->primitives);
+    free(r->depth);
+    free(r->pixels);
+    free(r);
+}
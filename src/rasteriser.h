@@ -0,0 +1,69 @@
+#ifndef RASTERISER_H_
+#define RASTERISER_H_
+
+// How far behind the depth buffer a line can be and still be drawn,
+// this stops lines lying in a plane from fighting with its fill
+#define RASTERISER_DEPTH_BIAS 0.5
+// How strongly a plane's colour shows in its fill, out of 255
+#define RASTERISER_FILL_ALPHA 64
+// The width and height of the tiles the framebuffer is split into, each
+// tile is rasterised by one worker
+#define RASTERISER_TILE_SIZE 64
+
+typedef enum RasteriserPrimitiveType_ {
+    RASTERISER_LINE,
+    RASTERISER_TRIANGLE
+} RasteriserPrimitiveType;
+
+// A projected line or triangle in framebuffer coordinates
+typedef struct RasteriserPrimitive_ {
+    float x[3];
+    float y[3];
+    float z[3];
+    Uint32 color;
+    RasteriserPrimitiveType type;
+} RasteriserPrimitive;
+
+typedef struct Rasteriser_ {
+
+    int width;
+    int height;
+    double scale;
+
+    Uint32* pixels;
+    float* depth;
+    SDL_Texture* texture;
+
+    SDL_Color color;
+    SDL_Color background;
+    // Whether the next flush clears the framebuffer first, only the
+    // first flush after a clear does so later ones draw on top
+    bool clearing;
+
+    int primitive_count;
+    int primitive_capacity;
+    RasteriserPrimitive* primitives;
+
+    int tiles_x;
+    int tiles_y;
+    int* bin_start;
+    int* bin_items;
+    int bin_capacity;
+
+    // The workers the tiles are rasterised on, shared and freed by the
+    // caller
+    ThreadPool* pool;
+
+} Rasteriser;
+
+Rasteriser* initialiseRasteriser(SDL_Renderer* renderer, int width, int height, double scale, ThreadPool* pool);
+void Rasteriser_clear(Rasteriser* r, SDL_Color background);
+void Rasteriser_setColor(Rasteriser* r, SDL_Color c);
+void Rasteriser_drawLine(Rasteriser* r, Tuple3* a, Tuple3* b);
+void Rasteriser_fillTriangle(Rasteriser* r, Tuple3* a, Tuple3* b, Tuple3* c);
+void Rasteriser_flush(Rasteriser* r);
+bool Rasteriser_save(Rasteriser* r, const char* file);
+void drawRasteriser(Rasteriser* r, SDL_Renderer* renderer);
+void freeRasteriser(Rasteriser* r);
+
+#endif
@@ -0,0 +1,265 @@
+#include      <SDL.h>
+#include    <stdio.h>
+#include   <string.h>
+#include    <ctype.h>
+#include  <stdbool.h>
+#include "recorder.h"
+
+// Reads the update the next line is for, finishing at the end of the file
+void readFrame(Recorder* r) {
+    if (fscanf(r->file, "%lu", &r->next_frame) != 1) r->finished = true;
+}
+
+// Opens a file to record to, or to replay from if replay is set, the
+// window IDs are saved as which window rather than the ID itself
+Recorder* initialiseRecorder(const char* file, bool replay, Uint32 graph_window, Uint32 input_window) {
+    FILE* f = fopen(file, replay ? "r" : "w");
+    if (f == NULL) return NULL;
+    if (replay) {
+        char header[64];
+        if (fgets(header, sizeof(header), f) == NULL
+                || strncmp(header, RECORDER_HEADER, strlen(RECORDER_HEADER)) != 0) {
+            fclose(f);
+            return NULL;
+        }
+    } else {
+        fprintf(f, "%s\n", RECORDER_HEADER);
+    }
+    Recorder* r = malloc(sizeof(Recorder));
+    r->file = f;
+    r->replaying = replay;
+    r->finished = false;
+    r->graph_window = graph_window;
+    r->input_window = input_window;
+    r->frame = 0;
+    r->next_frame = 0;
+    r->timing_count = 0;
+    r->timing_capacity = 0;
+    r->timings = NULL;
+    if (replay) readFrame(r);
+    return r;
+}
+
+// Writes text as hex so any characters fit on one line
+void writeHex(FILE* f, const char* s) {
+    if (*s == '\0') fputc('-', f);
+    for (; *s != '\0'; s++) fprintf(f, "%02x", (unsigned char) *s);
+}
+
+// Reads hex written by writeHex into a new string
+char* readHex(FILE* f) {
+    int length = 0, capacity = 32;
+    char* s = malloc(capacity);
+    int c = fgetc(f);
+    while (c == ' ') c = fgetc(f);
+    if (c == '-') c = fgetc(f);
+    while (isxdigit(c)) {
+        int next = fgetc(f);
+        if (!isxdigit(next)) break;
+        char pair[3] = { c, next, '\0' };
+        if (length + 1 >= capacity) {
+            capacity *= 2;
+            s = realloc(s, capacity);
+        }
+        s[length++] = strtol(pair, NULL, 16);
+        c = fgetc(f);
+    }
+    // Leave the end of the line to be skipped
+    if (c == '\n') ungetc(c, f);
+    s[length] = '\0';
+    return s;
+}
+
+// Gets which window an ID belongs to
+int windowIndex(Recorder* r, Uint32 id) {
+    if (id == r->graph_window) return 0;
+    if (id == r->input_window) return 1;
+    return -1;
+}
+
+// Writes an event with the windows that had focus, ignoring events the
+// program doesn't use
+void Recorder_record(Recorder* r, SDL_Event* e, int focus) {
+    if (r->replaying) return;
+    FILE* f = r->file;
+    switch (e->type) {
+        case SDL_QUIT:
+            fprintf(f, "%lu %d quit\n", r->frame, focus);
+        break;
+        case SDL_KEYUP:
+        case SDL_KEYDOWN:
+            // Save what a paste will read so the replay pastes the same
+            if (e->type == SDL_KEYDOWN && e->key.keysym.sym == SDLK_v
+                    && (e->key.keysym.mod & KMOD_CTRL)) {
+                char* text = SDL_GetClipboardText();
+                if (text != NULL) {
+                    fprintf(f, "%lu %d clipboard ", r->frame, focus);
+                    writeHex(f, text);
+                    fputc('\n', f);
+                    SDL_free(text);
+                }
+            }
+            fprintf(f, "%lu %d key %d %d %d %d %d\n", r->frame, focus,
+                    e->type == SDL_KEYDOWN, e->key.keysym.sym,
+                    e->key.keysym.scancode, e->key.keysym.mod, e->key.repeat);
+        break;
+        case SDL_TEXTINPUT:
+            fprintf(f, "%lu %d text ", r->frame, focus);
+            writeHex(f, e->text.text);
+            fputc('\n', f);
+        break;
+        case SDL_MOUSEMOTION:
+            fprintf(f, "%lu %d motion %d %d %d %d %u\n", r->frame, focus,
+                    e->motion.x, e->motion.y, e->motion.xrel, e->motion.yrel,
+                    e->motion.state);
+        break;
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEBUTTONDOWN:
+            fprintf(f, "%lu %d button %d %d %d %d %d\n", r->frame, focus,
+                    e->type == SDL_MOUSEBUTTONDOWN, e->button.button,
+                    e->button.x, e->button.y, e->button.clicks);
+        break;
+        case SDL_MOUSEWHEEL:
+            fprintf(f, "%lu %d wheel %d %d\n", r->frame, focus, e->wheel.x, e->wheel.y);
+        break;
+        case SDL_WINDOWEVENT:
+            fprintf(f, "%lu %d window %d %d %d %d\n", r->frame, focus,
+                    e->window.event, windowIndex(r, e->window.windowID),
+                    e->window.data1, e->window.data2);
+        break;
+    }
+}
+
+// Reads the rest of a line into an event, returning false if the line
+// isn't an event
+bool readEvent(Recorder* r, const char* kind, SDL_Event* e) {
+    FILE* f = r->file;
+    int a = 0, b = 0, c = 0, d = 0, g = 0;
+    memset(e, 0, sizeof(SDL_Event));
+    if (strcmp(kind, "quit") == 0) {
+        e->type = SDL_QUIT;
+    } else if (strcmp(kind, "key") == 0) {
+        if (fscanf(f, "%d %d %d %d %d", &a, &b, &c, &d, &g) != 5) return false;
+        e->type = a ? SDL_KEYDOWN : SDL_KEYUP;
+        e->key.state = a ? SDL_PRESSED : SDL_RELEASED;
+        e->key.keysym.sym = b;
+        e->key.keysym.scancode = c;
+        e->key.keysym.mod = d;
+        e->key.repeat = g;
+    } else if (strcmp(kind, "text") == 0) {
+        char* text = readHex(f);
+        e->type = SDL_TEXTINPUT;
+        strncpy(e->text.text, text, sizeof(e->text.text) - 1);
+        free(text);
+    } else if (strcmp(kind, "motion") == 0) {
+        unsigned int state;
+        if (fscanf(f, "%d %d %d %d %u", &a, &b, &c, &d, &state) != 5) return false;
+        e->type = SDL_MOUSEMOTION;
+        e->motion.x = a;
+        e->motion.y = b;
+        e->motion.xrel = c;
+        e->motion.yrel = d;
+        e->motion.state = state;
+    } else if (strcmp(kind, "button") == 0) {
+        if (fscanf(f, "%d %d %d %d %d", &a, &b, &c, &d, &g) != 5) return false;
+        e->type = a ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+        e->button.state = a ? SDL_PRESSED : SDL_RELEASED;
+        e->button.button = b;
+        e->button.x = c;
+        e->button.y = d;
+        e->button.clicks = g;
+    } else if (strcmp(kind, "wheel") == 0) {
+        if (fscanf(f, "%d %d", &a, &b) != 2) return false;
+        e->type = SDL_MOUSEWHEEL;
+        e->wheel.x = a;
+        e->wheel.y = b;
+    } else if (strcmp(kind, "window") == 0) {
+        if (fscanf(f, "%d %d %d %d", &a, &b, &c, &d) != 4) return false;
+        e->type = SDL_WINDOWEVENT;
+        e->window.event = a;
+        e->window.windowID = b == 0 ? r->graph_window : b == 1 ? r->input_window : 0;
+        e->window.data1 = c;
+        e->window.data2 = d;
+    } else if (strcmp(kind, "clipboard") == 0) {
+        // Put back what was on the clipboard for the paste after it
+        char* text = readHex(f);
+        SDL_SetClipboardText(text);
+        free(text);
+        return false;
+    } else if (strcmp(kind, "end") == 0) {
+        r->finished = true;
+        return false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Gets the next replayed event for this update and the windows that had
+// focus, returning false once there are none left for it
+bool Recorder_next(Recorder* r, SDL_Event* e, int* focus) {
+    while (r->replaying && !r->finished && r->next_frame <= r->frame) {
+        char kind[16];
+        if (fscanf(r->file, "%d %15s", focus, kind) != 2) {
+            r->finished = true;
+            break;
+        }
+        bool read = readEvent(r, kind, e);
+        // Skip to the next line, whatever is left of this one
+        int c;
+        while ((c = fgetc(r->file)) != '\n' && c != EOF);
+        if (!r->finished) readFrame(r);
+        if (read) return true;
+    }
+    return false;
+}
+
+// Moves on to the next update, keeping how long the last one took if
+// replaying
+void Recorder_endFrame(Recorder* r, double ms) {
+    r->frame++;
+    if (!r->replaying) return;
+    if (r->timing_count == r->timing_capacity) {
+        r->timing_capacity = r->timing_capacity == 0 ? 256 : r->timing_capacity * 2;
+        r->timings = realloc(r->timings, sizeof(double) * r->timing_capacity);
+    }
+    r->timings[r->timing_count++] = ms;
+}
+
+int compareTimings(const void* a, const void* b) {
+    double x = *(const double*) a, y = *(const double*) b;
+    return (x > y) - (x < y);
+}
+
+// Prints a summary of the update timings and writes each of them to a
+// CSV file if one is given
+bool Recorder_report(Recorder* r, const char* file) {
+    int n = r->timing_count;
+    if (n == 0) return true;
+    double* sorted = malloc(sizeof(double) * n);
+    memcpy(sorted, r->timings, sizeof(double) * n);
+    qsort(sorted, n, sizeof(double), compareTimings);
+    double total = 0;
+    for (int i = 0; i < n; i++) total += sorted[i];
+    printf("Replayed %d updates, mean %.3f ms, median %.3f ms, "
+            "95th %.3f ms, 99th %.3f ms, max %.3f ms\n",
+            n, total / n, sorted[(n - 1) / 2], sorted[(int) ((n - 1) * 0.95)],
+            sorted[(int) ((n - 1) * 0.99)], sorted[n - 1]);
+    free(sorted);
+    if (file == NULL) return true;
+    FILE* f = fopen(file, "w");
+    if (f == NULL) return false;
+    fprintf(f, "update,ms\n");
+    for (int i = 0; i < n; i++) fprintf(f, "%d,%.4f\n", i, r->timings[i]);
+    fclose(f);
+    return true;
+}
+
+// Closes the file, marking where a recording ends so a replay runs for
+// as many updates
+void freeRecorder(Recorder* r) {
+    if (!r->replaying) fprintf(r->file, "%lu 0 end\n", r->frame);
+    fclose(r->file);
+    free(r->timings);
+    free(r);
+}
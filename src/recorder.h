@@ -0,0 +1,46 @@
+#ifndef RECORDER_H_
+#define RECORDER_H_
+
+// The first line of every recording
+#define RECORDER_HEADER "projections-recording 1"
+
+// Which windows had focus when an event happened, stored with each event
+// so a replay goes to the same place without the windows being focused
+#define RECORDER_GRAPH_KEYS  1
+#define RECORDER_INPUT_KEYS  2
+#define RECORDER_GRAPH_MOUSE 4
+#define RECORDER_INPUT_MOUSE 8
+
+// Writes the events of a session to a file tagged with the update they
+// came before, or reads them back one update at a time. Events are
+// stamped with update numbers rather than times, as a replay runs at a
+// fixed virtual time and has to hand each event to the same update it
+// was recorded in for the frames to be the same, the wall clock timing
+// of the original session isn't kept
+typedef struct Recorder_ {
+
+    FILE* file;
+    bool replaying;
+    bool finished;
+    Uint32 graph_window;
+    Uint32 input_window;
+
+    // The number of updates so far
+    unsigned long frame;
+    // The update the next replayed line is for
+    unsigned long next_frame;
+
+    int timing_count;
+    int timing_capacity;
+    double* timings;
+
+} Recorder;
+
+Recorder* initialiseRecorder(const char* file, bool replay, Uint32 graph_window, Uint32 input_window);
+void Recorder_record(Recorder* r, SDL_Event* e, int focus);
+bool Recorder_next(Recorder* r, SDL_Event* e, int* focus);
+void Recorder_endFrame(Recorder* r, double ms);
+bool Recorder_report(Recorder* r, const char* file);
+void freeRecorder(Recorder* r);
+
+#endif
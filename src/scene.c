@@ -0,0 +1,185 @@
+#include         <SDL.h>
+#include      <string.h>
+#include     <stdbool.h>
+#include     <SDL_ttf.h>
+#include       "maths.h"
+#include        "item.h"
+#include   "intersect.h"
+#include   "gapBuffer.h"
+#include "inputWindow.h"
+#include       "scene.h"
+
+Scene* newScene() {
+    Scene* s = malloc(sizeof(Scene));
+    for (int i = 0; i < MAX_ITEMS; i++) parseItem(&s->items[i], "");
+    s->count = 0;
+    initialiseIntersections(&s->intersections);
+    return s;
+}
+
+void freeScene(Scene* s) {
+    if (s == NULL) return;
+    for (int i = 0; i < s->count; i++) releaseItem(&s->items[i]);
+    freeIntersections(&s->intersections);
+    free(s);
+}
+
+// Gets a scene for the worker to build into, reusing old ones if it can
+Scene* takeScene(SceneBuilder* b) {
+    Scene* s = b->spare;
+    if (s != NULL) {
+        b->spare = NULL;
+        return s;
+    }
+    s = SDL_AtomicSetPtr(&b->retired, NULL);
+    if (s != NULL) return s;
+    return newScene();
+}
+
+// Parses the lines into a copy of the newest scene and hands it over if
+// any item changed
+void buildScene(SceneBuilder* b, char** lines) {
+    Scene* s = takeScene(b);
+    // Only the used items need copying, past both counts they are all
+    // empty already
+    int count = s->count > b->latest->count ? s->count : b->latest->count;
+    for (int i = 0; i < s->count; i++) releaseItem(&s->items[i]);
+    memcpy(s->items, b->latest->items, sizeof(Item) * count);
+    for (int i = 0; i < count; i++) retainItem(&s->items[i]);
+    bool changed = false;
+    Item item;
+    for (int i = 0; i < MAX_ITEMS; i++) {
+        if (lines[i] == NULL) continue;
+        parseItem(&item, lines[i]);
+        free(lines[i]);
+        if (itemEquals(&item, &s->items[i])) {
+            releaseItem(&item);
+            continue;
+        }
+        releaseItem(&s->items[i]);
+        s->items[i] = item;
+        if (i >= count) count = i + 1;
+        changed = true;
+    }
+    while (count > 0 && s->items[count - 1].type == ITEM_NONE) count--;
+    s->count = count;
+    if (!changed) {
+        b->spare = s;
+        return;
+    }
+    // Anything changing can move the intersections
+    bool intersect = false;
+    for (int i = 0; i < s->count; i++) intersect |= s->items[i].type == ITEM_INTERSECT;
+    s->intersections.point_count = 0;
+    s->intersections.line_count = 0;
+    if (intersect) findIntersections(&s->intersections, s->items, s->count);
+    b->latest = s;
+    // A scene that was never swapped in was never drawn, so it can be
+    // built into next time
+    b->spare = SDL_AtomicSetPtr(&b->ready, s);
+}
+
+// The loop the worker runs, waiting for lines then building scenes
+int sceneThread(void* data) {
+    SceneBuilder* b = data;
+    char** lines = malloc(sizeof(char*) * MAX_ITEMS);
+    SDL_LockMutex(b->lock);
+    while (true) {
+        while (!b->quitting && b->line_count == 0) {
+            b->building = false;
+            SDL_CondBroadcast(b->idle);
+            SDL_CondWait(b->wake, b->lock);
+        }
+        if (b->quitting) break;
+        // Take the lines so more can be handed over while building
+        memcpy(lines, b->lines, sizeof(b->lines));
+        memset(b->lines, 0, sizeof(b->lines));
+        b->line_count = 0;
+        b->building = true;
+        SDL_UnlockMutex(b->lock);
+        buildScene(b, lines);
+        SDL_LockMutex(b->lock);
+    }
+    SDL_UnlockMutex(b->lock);
+    free(lines);
+    return 0;
+}
+
+SceneBuilder* initialiseSceneBuilder() {
+    SceneBuilder* b = malloc(sizeof(SceneBuilder));
+    b->lock = SDL_CreateMutex();
+    b->wake = SDL_CreateCond();
+    b->idle = SDL_CreateCond();
+    b->quitting = false;
+    b->building = false;
+    for (int i = 0; i < MAX_ITEMS; i++) b->lines[i] = NULL;
+    b->line_count = 0;
+    b->front = newScene();
+    b->swaps = 0;
+    b->latest = b->front;
+    b->spare = NULL;
+    b->ready = NULL;
+    b->retired = NULL;
+    b->thread = SDL_CreateThread(sceneThread, "scene", b);
+    return b;
+}
+
+// Hands a line over to be parsed, replacing it if it hasn't been yet
+void SceneBuilder_setLine(SceneBuilder* b, int i, const char* line) {
+    char* copy = malloc(strlen(line) + 1);
+    strcpy(copy, line);
+    SDL_LockMutex(b->lock);
+    if (b->lines[i] == NULL) {
+        b->line_count++;
+    } else {
+        free(b->lines[i]);
+    }
+    b->lines[i] = copy;
+    SDL_UnlockMutex(b->lock);
+}
+
+// Starts the worker on the lines handed over
+void SceneBuilder_submit(SceneBuilder* b) {
+    SDL_LockMutex(b->lock);
+    if (b->line_count > 0) SDL_CondSignal(b->wake);
+    SDL_UnlockMutex(b->lock);
+}
+
+// Swaps in the newest built scene, returning whether there was one, this
+// must be called between frames as the old scene is given back to the
+// worker
+bool SceneBuilder_swap(SceneBuilder* b) {
+    Scene* s = SDL_AtomicGetPtr(&b->ready);
+    if (s == NULL || !SDL_AtomicCASPtr(&b->ready, s, NULL)) return false;
+    if (!SDL_AtomicCASPtr(&b->retired, NULL, b->front)) freeScene(b->front);
+    b->front = s;
+    b->swaps++;
+    return true;
+}
+
+// Waits for every line handed over to be parsed then swaps in the
+// result, for when the frames drawn have to be the same every time
+bool SceneBuilder_wait(SceneBuilder* b) {
+    SDL_LockMutex(b->lock);
+    if (b->line_count > 0) SDL_CondSignal(b->wake);
+    while (b->line_count > 0 || b->building) SDL_CondWait(b->idle, b->lock);
+    SDL_UnlockMutex(b->lock);
+    return SceneBuilder_swap(b);
+}
+
+void freeSceneBuilder(SceneBuilder* b) {
+    SDL_LockMutex(b->lock);
+    b->quitting = true;
+    SDL_CondSignal(b->wake);
+    SDL_UnlockMutex(b->lock);
+    SDL_WaitThread(b->thread, NULL);
+    for (int i = 0; i < MAX_ITEMS; i++) free(b->lines[i]);
+    freeScene(b->front);
+    freeScene(b->ready);
+    freeScene(b->retired);
+    freeScene(b->spare);
+    SDL_DestroyCond(b->wake);
+    SDL_DestroyCond(b->idle);
+    SDL_DestroyMutex(b->lock);
+    free(b);
+}
@@ -0,0 +1,56 @@
+#ifndef SCENE_H_
+#define SCENE_H_
+
+// The parsed items the graph is drawn from
+typedef struct Scene_ {
+    Item items[MAX_ITEMS];
+    // One past the last item that isn't empty, every item from here on
+    // is empty
+    int count;
+    // Where the items meet, if there is an intersect item
+    Intersections intersections;
+} Scene;
+
+// Parses edited lines on a worker thread into new scenes, which the main
+// thread swaps in between frames so parsing never holds up a frame
+typedef struct SceneBuilder_ {
+
+    SDL_Thread* thread;
+    SDL_mutex* lock;
+    // Signalled when lines are handed over or when quitting
+    SDL_cond* wake;
+    // Signalled when the worker runs out of lines
+    SDL_cond* idle;
+    bool quitting;
+    bool building;
+
+    // Lines handed over but not parsed yet, NULL where nothing changed,
+    // guarded by the lock
+    char* lines[MAX_ITEMS];
+    int line_count;
+
+    // The newest scene built, which the next one starts as a copy of,
+    // and a scene to build into next, both only used by the worker
+    Scene* latest;
+    Scene* spare;
+
+    // A built scene waiting to be swapped in, and the last scene drawn
+    // before a swap, for the worker to reuse
+    void* ready;
+    void* retired;
+
+    // The scene being drawn, only used by the main thread, and how many
+    // scenes have been swapped in so it can tell when front has changed
+    Scene* front;
+    unsigned long swaps;
+
+} SceneBuilder;
+
+SceneBuilder* initialiseSceneBuilder();
+void SceneBuilder_setLine(SceneBuilder* b, int i, const char* line);
+void SceneBuilder_submit(SceneBuilder* b);
+bool SceneBuilder_swap(SceneBuilder* b);
+bool SceneBuilder_wait(SceneBuilder* b);
+void freeSceneBuilder(SceneBuilder* b);
+
+#endif
@@ -0,0 +1,108 @@
+#include     <SDL.h>
+#include   <stdio.h>
+#include  <stdlib.h>
+#include  <string.h>
+#include <stdbool.h>
+#include   "maths.h"
+#include    "item.h"
+#include  "stream.h"
+
+// Where the reader or the main thread are in the ring, wrapped at twice
+// its size
+#define STREAM_INDEX_MASK (2 * STREAM_RING_SIZE - 1)
+
+// Parses a record, only points, lines and planes of plain numbers are
+// streamed
+bool parseRecord(Item* item, const char* line) {
+    parseItem(item, line);
+    bool plain = item->data == NULL;
+    releaseItem(item);
+    return plain && (item->type == ITEM_POINT || item->type == ITEM_LINE || item->type == ITEM_PLANE);
+}
+
+// Reads records until the file ends or the stream is freed, waiting for
+// the main thread to make room if the ring is full
+int streamThread(void* data) {
+    Stream* s = data;
+    char line[STREAM_LINE_LENGTH + 2];
+    bool skipping = false;
+    while (SDL_AtomicGet(&s->quitting) == 0 && fgets(line, sizeof(line), s->file) != NULL) {
+        // The rest of a line too long to fit is skipped along with it
+        bool whole = strchr(line, '\n') != NULL || feof(s->file);
+        bool skip = skipping || !whole;
+        skipping = !whole;
+        Item item;
+        if (skip || !parseRecord(&item, line)) continue;
+        int head = SDL_AtomicGet(&s->head);
+        while (((head - SDL_AtomicGet(&s->tail)) & STREAM_INDEX_MASK) == STREAM_RING_SIZE) {
+            if (SDL_AtomicGet(&s->quitting) != 0) return 0;
+            SDL_Delay(1);
+        }
+        s->ring[head & (STREAM_RING_SIZE - 1)] = item;
+        // The record has to be written before the main thread can see it
+        SDL_MemoryBarrierRelease();
+        SDL_AtomicSet(&s->head, (head + 1) & STREAM_INDEX_MASK);
+    }
+    SDL_AtomicSet(&s->finished, 1);
+    return 0;
+}
+
+// Starts reading records from the file, or stdin if it is "-", keeping
+// the newest keep of them, returning NULL if the file can't be opened,
+// opening a named pipe waits on the reader's thread for a writer
+Stream* initialiseStream(const char* file, int keep) {
+    FILE* f = stdin;
+    if (strcmp(file, "-") != 0) f = fopen(file, "r");
+    if (f == NULL) return NULL;
+    if (keep < 1) keep = STREAM_DEFAULT_KEEP;
+    Stream* s = malloc(sizeof(Stream));
+    s->file = f;
+    SDL_AtomicSet(&s->quitting, 0);
+    SDL_AtomicSet(&s->finished, 0);
+    SDL_AtomicSet(&s->head, 0);
+    SDL_AtomicSet(&s->tail, 0);
+    s->keep = keep;
+    s->count = 0;
+    s->next = 0;
+    s->window = malloc(sizeof(Item) * keep);
+    s->thread = SDL_CreateThread(streamThread, "stream", s);
+    return s;
+}
+
+// Moves every record waiting in the ring into the window, returning how
+// many were moved
+int Stream_update(Stream* s) {
+    int tail = SDL_AtomicGet(&s->tail);
+    int head = SDL_AtomicGet(&s->head);
+    // The records up to the head have to be read after it
+    SDL_MemoryBarrierAcquire();
+    int moved = 0;
+    for (; tail != head; tail = (tail + 1) & STREAM_INDEX_MASK, moved++) {
+        s->window[s->next] = s->ring[tail & (STREAM_RING_SIZE - 1)];
+        s->next = s->next + 1 == s->keep ? 0 : s->next + 1;
+        if (s->count < s->keep) s->count++;
+    }
+    SDL_AtomicSet(&s->tail, tail);
+    return moved;
+}
+
+// Gets the ith record kept, oldest first
+Item* Stream_get(Stream* s, int i) {
+    int index = s->next - s->count + i;
+    if (index < 0) index += s->keep;
+    return &s->window[index];
+}
+
+// Stops the reader, one still waiting for a record can't be stopped so
+// it is left to end with the program, along with what it uses
+void freeStream(Stream* s) {
+    SDL_AtomicSet(&s->quitting, 1);
+    if (SDL_AtomicGet(&s->finished) == 0) {
+        SDL_DetachThread(s->thread);
+        return;
+    }
+    SDL_WaitThread(s->thread, NULL);
+    if (s->file != stdin) fclose(s->file);
+    free(s->window);
+    free(s);
+}
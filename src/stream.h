@@ -0,0 +1,44 @@
+#ifndef STREAM_H_
+#define STREAM_H_
+
+// How many records can wait between the reader and the main thread, a
+// power of two
+#define STREAM_RING_SIZE 4096
+// The longest record that is read, longer lines are skipped
+#define STREAM_LINE_LENGTH 255
+// How many of the newest records are kept when not given
+#define STREAM_DEFAULT_KEEP 10000
+
+// Reads point, line and plane records from a file, pipe or stdin on a
+// thread of its own, handing them to the main thread through a ring that
+// each side only moves its own end of, so neither ever waits on a lock,
+// and keeps the newest of them in a rolling window
+typedef struct Stream_ {
+
+    SDL_Thread* thread;
+    FILE* file;
+    SDL_atomic_t quitting;
+    SDL_atomic_t finished;
+
+    // Records are written at the head by the reader and taken from the
+    // tail by the main thread, both count up to twice the size so a full
+    // ring can be told from an empty one
+    Item ring[STREAM_RING_SIZE];
+    SDL_atomic_t head;
+    SDL_atomic_t tail;
+
+    // The newest records, only used by the main thread, the oldest is
+    // overwritten once it is full
+    int keep;
+    int count;
+    int next;
+    Item* window;
+
+} Stream;
+
+Stream* initialiseStream(const char* file, int keep);
+int Stream_update(Stream* s);
+Item* Stream_get(Stream* s, int i);
+void freeStream(Stream* s);
+
+#endif
@@ -0,0 +1,76 @@
+#include        <SDL.h>
+#include    <stdbool.h>
+#include "threadPool.h"
+
+// Takes jobs from the pool until there are none left
+void takeJobs(ThreadPool* pool, int worker) {
+    int job;
+    while ((job = SDL_AtomicAdd(&pool->next, 1)) < pool->jobs) {
+        pool->job(pool->data, job, worker);
+    }
+}
+
+typedef struct Worker_ {
+    ThreadPool* pool;
+    int index;
+} Worker;
+
+// The loop each worker thread runs, waiting to be started then helping
+// with the jobs
+int workerThread(void* data) {
+    Worker* w = data;
+    ThreadPool* pool = w->pool;
+    int index = w->index;
+    free(w);
+    while (true) {
+        SDL_SemWait(pool->start);
+        if (pool->quitting) break;
+        takeJobs(pool, index);
+        SDL_SemPost(pool->done);
+    }
+    return 0;
+}
+
+// Creates a pool with the given number of workers, including the
+// thread that calls run, so a pool of one runs everything itself
+ThreadPool* initialiseThreadPool(int workers) {
+    ThreadPool* pool = malloc(sizeof(ThreadPool));
+    if (workers < 1) workers = 1;
+    pool->workers = workers;
+    pool->threads = malloc(sizeof(SDL_Thread*) * workers);
+    pool->start = SDL_CreateSemaphore(0);
+    pool->done = SDL_CreateSemaphore(0);
+    pool->quitting = false;
+    pool->jobs = 0;
+    SDL_AtomicSet(&pool->next, 0);
+    pool->job = NULL;
+    pool->data = NULL;
+    for (int i = 1; i < workers; i++) {
+        Worker* w = malloc(sizeof(Worker));
+        w->pool = pool;
+        w->index = i;
+        pool->threads[i] = SDL_CreateThread(workerThread, "worker", w);
+    }
+    return pool;
+}
+
+// Runs the jobs across the workers and returns once they are all done
+void ThreadPool_run(ThreadPool* pool, int jobs, ThreadPool_Job job, void* data) {
+    pool->jobs = jobs;
+    pool->job = job;
+    pool->data = data;
+    SDL_AtomicSet(&pool->next, 0);
+    for (int i = 1; i < pool->workers; i++) SDL_SemPost(pool->start);
+    takeJobs(pool, 0);
+    for (int i = 1; i < pool->workers; i++) SDL_SemWait(pool->done);
+}
+
+void freeThreadPool(ThreadPool* pool) {
+    pool->quitting = true;
+    for (int i = 1; i < pool->workers; i++) SDL_SemPost(pool->start);
+    for (int i = 1; i < pool->workers; i++) SDL_WaitThread(pool->threads[i], NULL);
+    SDL_DestroySemaphore(pool->start);
+    SDL_DestroySemaphore(pool->done);
+    free(pool->threads);
+    free(pool);
+}
@@ -0,0 +1,27 @@
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+// A job is given the pool's data, the index of the job and the index of
+// the worker running it, which is 0 for the thread that called run
+typedef void (*ThreadPool_Job)(void* data, int job, int worker);
+
+typedef struct ThreadPool_ {
+
+    int workers;
+    SDL_Thread** threads;
+    SDL_sem* start;
+    SDL_sem* done;
+
+    bool quitting;
+    int jobs;
+    SDL_atomic_t next;
+    ThreadPool_Job job;
+    void* data;
+
+} ThreadPool;
+
+ThreadPool* initialiseThreadPool(int workers);
+void ThreadPool_run(ThreadPool* pool, int jobs, ThreadPool_Job job, void* data);
+void freeThreadPool(ThreadPool* pool);
+
+#endif
@@ -0,0 +1,38 @@
+#include       <SDL.h>
+#include    <stdlib.h>
+#include   <stdbool.h>
+#include     "maths.h"
+#include "viewCache.h"
+
+ViewCache* initialiseViewCache() {
+    ViewCache* c = malloc(sizeof(ViewCache));
+    c->count = 0;
+    c->capacity = 1024;
+    c->segments = malloc(sizeof(CachedSegment) * c->capacity);
+    return c;
+}
+
+// Forgets every segment, ready for the next frame
+void ViewCache_clear(ViewCache* c) {
+    c->count = 0;
+}
+
+// Adds a segment between two scaled points, with the pixel offsets of
+// its ends if it is drawn around one point or NULL if it isn't
+void ViewCache_add(ViewCache* c, Tuple3* a, Tuple3* b, int offsets[4], int item, SDL_Color color) {
+    if (c->count == c->capacity) {
+        c->capacity <<= 1;
+        c->segments = realloc(c->segments, sizeof(CachedSegment) * c->capacity);
+    }
+    CachedSegment* s = &c->segments[c->count++];
+    s->a = (Point) { a->a, a->b, a->c };
+    s->b = (Point) { b->a, b->b, b->c };
+    for (int i = 0; i < 4; i++) s->offsets[i] = offsets == NULL ? 0 : offsets[i];
+    s->item = item;
+    s->color = color;
+}
+
+void freeViewCache(ViewCache* c) {
+    free(c->segments);
+    free(c);
+}
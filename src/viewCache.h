@@ -0,0 +1,28 @@
+#ifndef VIEWCACHE_H_
+#define VIEWCACHE_H_
+
+// A segment of the graph before any view is applied, its ends are points
+// scaled down by the zoom, and a segment drawn a fixed number of pixels
+// from a point has that point as both ends and the pixels as offsets
+typedef struct CachedSegment_ {
+    Point a;
+    Point b;
+    short offsets[4];
+    int item;
+    SDL_Color color;
+} CachedSegment;
+
+// The segments of a whole frame, made once and then drawn through each
+// view of the split screen
+typedef struct ViewCache_ {
+    int count;
+    int capacity;
+    CachedSegment* segments;
+} ViewCache;
+
+ViewCache* initialiseViewCache();
+void ViewCache_clear(ViewCache* c);
+void ViewCache_add(ViewCache* c, Tuple3* a, Tuple3* b, int offsets[4], int item, SDL_Color color);
+void freeViewCache(ViewCache* c);
+
+#endif